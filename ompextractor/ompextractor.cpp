@@ -38,6 +38,23 @@
 //  clang -Xclang -load -Xclang $SCOPE -Xclang -add-plugin -Xclang -extract-omp
 //
 //  Where $SCOPE -> points to the ompextractor.so shared library file location 
+//
+//Plugin arguments are given with -Xclang -plugin-arg-extract-omp -Xclang <arg>:
+//
+//  -code-snippet-gen         emits the source code of each loop in its record
+//  -machine-desc=<file>      reads the machine description used by the roofline
+//                            classification. Each line holds a "key value" pair,
+//                            lines starting with '#' are ignored. Known keys:
+//                              peak_gflops     peak floating point rate (GFLOP/s)
+//                              bandwidth_gbs   peak memory bandwidth (GB/s)
+//                              threads         number of threads of a team
+//                              cache_line      cache line size (bytes)
+//                              min_parallel_work   operations a parallel loop needs
+//                                                  to pay off its fork/join
+//                              min_offload_work    operations a target loop needs
+//                                                  to pay off its launch
+//                              l1_cache        L1 data cache size (bytes)
+//                              l2_cache        L2 cache size (bytes)
 //===-----------------------------------------------------------------------===
 
 #include "clang/Driver/Options.h"
@@ -52,6 +69,9 @@
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendPluginRegistry.h"
 #include "clang/Rewrite/Core/Rewriter.h"
+#include "llvm/Support/Format.h"
+#include <algorithm>
+#include <set>
 #include <stack>
 #include <map>
 #include <vector>
@@ -81,6 +101,125 @@ typedef struct relative_loop_inst_id {
   long long int loopInstructionID;
 } relative_loop_inst_id;
 
+/*POD struct that represents an array element or pointer dereference found
+inside a loop body, with the variable that provides the accessed memory*/
+struct MemAccess {
+  Expr *expr;
+  ValueDecl *base;
+  bool isRead;
+  bool isWrite;
+  unsigned int bytes;
+  std::string pattern;
+  long long int stride;
+  std::string reductionOp;
+};
+
+/*POD struct with the static cost estimate of a single iteration of a loop
+body: floating point operations and bytes moved from/to memory*/
+struct LoopCost {
+  unsigned int flops;
+  unsigned int bytesLoaded;
+  unsigned int bytesStored;
+};
+
+/*POD struct that represents the iteration space of a for loop. Bounds, step
+and trip count are kept as source strings, folded into constants whenever
+possible (literals, macros, constexpr values)*/
+struct LoopBounds {
+  VarDecl *inductionVar;
+  Expr *lowerExpr;
+  Expr *upperExpr;
+  BinaryOperator::Opcode comparison;
+  std::string lower;
+  std::string upper;
+  std::string step;
+  std::string tripCount;
+  bool lowerConst;
+  bool upperConst;
+  bool stepConst;
+  bool tripConst;
+  long long int lowerValue;
+  long long int upperValue;
+  long long int stepValue;
+  long long int tripValue;
+};
+
+/*POD struct that represents a read and/or write of a scalar variable inside a
+loop body. Accesses are kept in evaluation order, and flagged when they only
+happen under a condition or when they are part of an associative update of
+the variable (reduction)*/
+struct ScalarAccess {
+  VarDecl *var;
+  Expr *ref;
+  bool isRead;
+  bool isWrite;
+  bool conditional;
+  std::string reductionOp;
+};
+
+/*POD struct that represents a subscript in affine form with respect to a loop
+induction variable: coefficient * var + offset + symbolic loop invariant terms.
+Subscripts that use induction variables of nested loops are flagged as varying*/
+struct AffineSubscript {
+  long long int coefficient;
+  long long int offset;
+  std::string symbolic;
+  bool varying;
+};
+
+/*POD struct with the result of the dependence analysis of a loop. Scalars
+declared outside the loop are classified as "read only", "reduction",
+"private" (written before read in every iteration) or "carried", and listed
+in the order they are first accessed*/
+struct DependenceInfo {
+  std::string verdict;
+  vector<std::string> reductions;
+  vector<Expr*> reductionRefs;
+  vector<std::string> privates;
+  vector<std::string> blocking;
+  map<VarDecl*, std::string> scalarKinds;
+  vector<VarDecl*> scalarOrder;
+  bool assumesNoAlias;
+};
+
+/*POD struct that represents a list item of a map clause: the variable or array
+section mapped, its map type and the bytes it moves. Sizes that can't be folded
+are kept as strings*/
+struct MappedData {
+  ValueDecl *decl;
+  Expr *expr;
+  OpenMPMapClauseKind mapType;
+  bool implicit;
+  bool sizeKnown;
+  bool bytesConst;
+  long long int bytesValue;
+  std::string bytes;
+};
+
+/*POD struct that represents a variable moved again and again between host and
+device: the mapped expression and whether it has to be copied to the device and
+back from it*/
+struct RedundantTransfer {
+  ValueDecl *decl;
+  std::string expr;
+  bool to;
+  bool from;
+};
+
+/*POD struct that describes the target machine, used to turn the static cost
+of a loop into a roofline classification, to estimate how threads share
+cache lines and to tell which working sets fit in cache*/
+struct MachineDesc {
+  double peakGflops = 1000.0;
+  double bandwidthGBs = 200.0;
+  unsigned int threads = 16;
+  unsigned int cacheLine = 64;
+  double minParallelWork = 100000.0;
+  double minOffloadWork = 10000000.0;
+  unsigned int l1Cache = 32768;
+  unsigned int l2Cache = 1048576;
+};
+
 /*POD struct that represents an input file in a Translation Unit (a single
 source/header file). Each input file will have its own stack of traversable
 nodes, and output file + associated information*/
@@ -123,14 +262,17 @@ private:
     ASTContext *astContext; //provides AST context info
     MangleContext *mangleContext;
     bool ClDCSnippet;
+    MachineDesc machine;
+    map<Stmt*, DependenceInfo> dependenceCache; //dependence analysis of each loop, computed once
 
 public:
     
-    explicit PragmaVisitor(CompilerInstance *CI, bool ClDCSnippet) 
+    explicit PragmaVisitor(CompilerInstance *CI, bool ClDCSnippet, MachineDesc machine) 
       : astContext(&(CI->getASTContext())) { // initialize private members
         rewriter.setSourceMgr(astContext->getSourceManager(),
         astContext->getLangOpts());
 	this->ClDCSnippet = ClDCSnippet;
+	this->machine = machine;
     }
 
     /*creates Node struct for a Stmt type or subtype
@@ -173,6 +315,13 @@ public:
 	currFile.labels += "\"ordered\":\"false\",\n";
 	currFile.labels += "\"offload\":\"false\",\n";
 	currFile.labels += "\"multiversioned\":\"false\"";
+
+	DependenceInfo & dependences = getDependences(st);
+	currFile.labels += getDependenceInfo(dependences);
+	currFile.labels += getAliasingInfo(st, dependences);
+	currFile.labels += getInterchangeInfo(st, nullptr);
+	currFile.labels += getTilingInfo(st, nullptr);
+
         if (ClDCSnippet == true)
 	  currFile.labels += ",\n\"code snippet\":[" + snippet + "]";
 	currFile.labels += "\n},\n";
@@ -348,6 +497,24 @@ public:
       }
     }
 
+    /*name of the kind of a schedule clause*/
+    std::string getScheduleKindName(OpenMPScheduleClauseKind kind) {
+      switch (kind) {
+        case OMPC_SCHEDULE_static:
+          return "static";
+        case OMPC_SCHEDULE_dynamic:
+          return "dynamic";
+        case OMPC_SCHEDULE_guided:
+          return "guided";
+        case OMPC_SCHEDULE_auto:
+          return "auto";
+        case OMPC_SCHEDULE_runtime:
+          return "runtime";
+        default:
+          return "unknown";
+      }
+    }
+
     /*find clauses's variable lists and classify them depending of the clause used
      * (for example "private","shared", etc)*/
     void ClassifyClause(OMPClause *clause, map<string, string> & clauseType) {
@@ -366,6 +533,15 @@ public:
         clauseType["collapse"] = getStrForStmt(OMPCc->getNumForLoops());
       }
 
+      /*Schedule clause, with its chunk size when one is given.*/
+      if (OMPScheduleClause *OMPcl = dyn_cast<OMPScheduleClause>(clause)) {
+        clauseType["schedule"] = getScheduleKindName(OMPcl->getScheduleKind());
+        if (Expr *chunkExpr = OMPcl->getChunkSize()) {
+          long long int chunk;
+          clauseType["schedule chunk"] = evaluateInt(chunkExpr, chunk) ? to_string(chunk) : exprToString(chunkExpr);
+        }
+      }
+
       /*Ordered clause.*/
       if (OMPOrderedClause *OMPcl = dyn_cast<OMPOrderedClause>(clause)) {
         clauseType["ordered"] = "true";
@@ -482,11 +658,48 @@ public:
         currFile.labels += "\"DediDeclRefcount\":\"" + to_string(currFile.DediDeclRefcount) + "\",\n";
         currFile.labels += "\"TotalDeclRefcount\":\"" + to_string(currFile.TotalDeclRefcount) + "\",\n";
 
+        LoopCost cost;
+        estimateLoopCost(body, cost);
+        currFile.labels += "\"flops\":\"" + to_string(cost.flops) + "\",\n";
+        currFile.labels += "\"bytes loaded\":\"" + to_string(cost.bytesLoaded) + "\",\n";
+        currFile.labels += "\"bytes stored\":\"" + to_string(cost.bytesStored) + "\",\n";
+        currFile.labels += getRooflineInfo(cost);
+
         currFile.labels += "\"ordered\":\"" + ((clauseType.count("ordered") > 0) ? (clauseType["ordered"]) : "false") + "\",\n";
         currFile.labels += "\"offload\":\"" + ((clauseType.count("offload") > 0) ? (clauseType["offload"]) : "false") + "\",\n";
 	currFile.labels += "\"multiversioned\":\""+ ((clauseType.count("multiversioned") > 0) ? (clauseType["multiversioned"]) : "false") + "\"";
+	if (clauseType.count("schedule") > 0)
+	  currFile.labels += ",\n\"schedule\":\"" + clauseType["schedule"] + "\"";
+	if (clauseType.count("schedule chunk") > 0)
+	  currFile.labels += ",\n\"schedule chunk\":\"" + clauseType["schedule chunk"] + "\"";
 	if (inductionVar != std::string())
 	  currFile.labels += ",\n\"induction variable\":\"" + inductionVar + "\"";
+	currFile.labels += getLoopBoundsInfo(st);
+	currFile.labels += getAccessPatternInfo(st);
+
+	DependenceInfo & dependences = getDependences(st);
+	currFile.labels += getMissingReductionInfo(st, dependences, clauseType);
+	currFile.labels += getPrivatizationInfo(st, dependences, clauseType);
+	currFile.labels += getSharedWriteInfo(st, clauseType);
+	currFile.labels += getFalseSharingInfo(st, clauseType);
+	currFile.labels += getLoadBalanceInfo(st, clauseType);
+	currFile.labels += getOverheadInfo(st);
+	currFile.labels += getVectorizationInfo(st, dependences);
+	currFile.labels += getAliasingInfo(st, dependences);
+	if (OMPExecutableDirective *OMPED = getLoopDirective(st))
+	  if (isa<OMPLoopDirective>(OMPED) && OMPED->getInnermostCapturedStmt()->getCapturedStmt() == st)
+	    currFile.labels += getCollapseInfo(OMPED) + getInterchangeInfo(st, OMPED) + getTilingInfo(st, OMPED);
+	if (OMPExecutableDirective *OMPED = getLoopDirective(st))
+	  if (isForkingDirective(OMPED) && OMPED->getInnermostCapturedStmt()->getCapturedStmt() == st) {
+	    currFile.labels += getHoistingInfo(OMPED);
+	    if (isParallelConstruct(OMPED))
+	      currFile.labels += getNestingInfo(OMPED);
+	    if (isTargetDirective(OMPED)) {
+	      currFile.labels += getOffloadVolumeInfo(OMPED, st);
+	      currFile.labels += getMapNarrowingInfo(OMPED);
+	      currFile.labels += getKernelShapeInfo(OMPED);
+	    }
+	  }
 	if (clauseType.count("shared") > 0)
 	  currFile.labels += ",\n\"shared\":[" + ((clauseType.count("shared") > 0) ? (clauseType["shared"]) : "") + "]";
         if (clauseType.count("private") > 0)
@@ -597,7 +810,7 @@ public:
     }
 
     /*Use Abstract Handles to represent target information into the source code*/
-    void insertStmtDirectives(Stmt *st, std::string directive, std::string snippet, map<string, string> & clauses) {
+    void insertStmtDirectives(Stmt *st, std::string directive, std::string snippet, std::string fields, map<string, string> & clauses) {
       struct InputFile& currFile = FileStack.top();
       
       FullSourceLoc StartLocation = astContext->getFullLoc(st->getBeginLoc());
@@ -615,6 +828,7 @@ public:
 
       currFile.labels += "\"snippet line\":\"" + to_string(StartLocation.getSpellingLineNumber()) + "\",\n";
       currFile.labels += "\"snippet column\":\"" + to_string(StartLocation.getSpellingColumnNumber()) + "\"";
+      currFile.labels += fields;
 
       if (ClDCSnippet == true)
       currFile.labels += ",\n\"code snippet\":[" + snippet + "]";
@@ -628,6 +842,26 @@ public:
     }
 
 
+    /*creates a record for an OpenMP construct that is not a loop, holding the results
+     * of the analyses done over its region*/
+    void insertRegionNode(Stmt *st, std::string directive, std::string fields) {
+      struct InputFile& currFile = FileStack.top();
+
+      FullSourceLoc StartLocation = astContext->getFullLoc(st->getBeginLoc());
+      if (!StartLocation.isValid()) {
+        return;
+      }
+
+      currFile.labels += "\"" + directive + " - object id : " + std::to_string(opCount++) + "\":{\n";
+      currFile.labels += "\"pragma type\":\"" + directive + "\",\n";
+      currFile.labels += "\"file\":\"" + currFile.filename + "\",\n";
+      currFile.labels += "\"function\":\"" + currFile.mapFunctionName[st] + "\",\n";
+      currFile.labels += "\"region line\":\"" + to_string(StartLocation.getSpellingLineNumber()) + "\",\n";
+      currFile.labels += "\"region column\":\"" + to_string(StartLocation.getSpellingColumnNumber()) + "\"";
+      currFile.labels += fields;
+      currFile.labels += "\n},\n";
+    }
+
     void statList(vector<Stmt*>& nodelist)
     {
       struct InputFile& currFile = FileStack.top();
@@ -731,210 +965,4411 @@ public:
       }
     }
 
-    /*associate the information of some node in the AST to it's sub tree. Important to normalize
-     * standart information on each loop.*/
-    void associateEachLoopInside(OMPExecutableDirective *OMPED, map<string, string> & clauses) {
-      struct InputFile& currFile = FileStack.top();
-      vector<Stmt*> nodes_list;
-      visitNodes(OMPED, nodes_list);
-      llvm::outs() << "associateEachLoopInside vector size: " << nodes_list.size() << "\n";
-      statList(nodes_list);
-
-      if (currFile.visited.count(OMPED) != 0)
-	return;
-      currFile.visited[OMPED] = true;
+    /*size in bytes of a type, or 0 when it can't be known statically*/
+    unsigned int getTypeBytes(QualType type) {
+      if (type.isNull() || type->isIncompleteType() || type->isDependentType())
+        return 0;
+      return astContext->getTypeSizeInChars(type).getQuantity();
+    }
 
-      if (isTargetDirective(OMPED))
-        clauses["offload"] = "true";
+    /*find the variable (or field) holding the memory reached by an array subscript
+     * or a pointer dereference, for example "a" for a[i][j], *(a + i) or s.a[i]*/
+    ValueDecl *getAccessBase(Expr *ex) {
+      ex = ex->IgnoreParenImpCasts();
+      if (ArraySubscriptExpr *ASExp = dyn_cast<ArraySubscriptExpr>(ex))
+        return getAccessBase(ASExp->getBase());
+      if (DeclRefExpr *DRex = dyn_cast<DeclRefExpr>(ex))
+        return DRex->getDecl();
+      if (MemberExpr *MEx = dyn_cast<MemberExpr>(ex)) {
+        if (isElementField(MEx))
+          return getAccessBase(MEx->getBase());
+        return MEx->getMemberDecl();
+      }
+      if (UnaryOperator *Uop = dyn_cast<UnaryOperator>(ex))
+        return getAccessBase(Uop->getSubExpr());
+      if (BinaryOperator *biop = dyn_cast<BinaryOperator>(ex)) {
+        if (biop->getLHS()->getType()->isPointerType())
+          return getAccessBase(biop->getLHS());
+        if (biop->getRHS()->getType()->isPointerType())
+          return getAccessBase(biop->getRHS());
+      }
+      return nullptr;
+    }
 
-      if (isa<OMPParallelDirective>(OMPED)) 
-        clauses["parallel"] = "true";
+    /*check if a member expression reaches a field of an array element or of a
+     * pointed struct (a[i].x, p->x), which lives in memory like the element itself*/
+    bool isElementField(MemberExpr *MEx) {
+      if (MEx->isArrow())
+        return true;
+      Expr *base = MEx->getBase()->IgnoreParenImpCasts();
+      if (isa<ArraySubscriptExpr>(base))
+        return true;
+      if (MemberExpr *baseMEx = dyn_cast<MemberExpr>(base))
+        return isElementField(baseMEx);
+      return false;
+    }
 
-      if (isa<OMPOrderedDirective>(OMPED)) {
-	  const SourceManager& mng = astContext->getSourceManager();
-	  std::string snippet = std::string();
-	  if (ClDCSnippet == true)
-	    snippet = getSourceSnippet(OMPED->getInnermostCapturedStmt()->getSourceRange(), true, true);
-/*
-        llvm::raw_string_ostream outstream(snippet);
-        //body->printPretty(outstream, NULL, PrintingPolicy(lo));
-        OMPED->getInnermostCapturedStmt()->dump(outstream, *astContext);
-        //errs() << "loop body: " << snippet << "\n"; 
-*/
-	  insertStmtDirectives(OMPED, "ordered", snippet, clauses);
+    /*names of the fields selected by an access, as ".pos.x" for a[i].pos.x*/
+    std::string getFieldPath(Expr *ex) {
+      std::string path = std::string();
+      MemberExpr *MEx = dyn_cast<MemberExpr>(ex->IgnoreParenImpCasts());
+      while (MEx) {
+        path = "." + MEx->getMemberDecl()->getNameAsString() + path;
+        MEx = MEx->isArrow() ? nullptr : dyn_cast<MemberExpr>(MEx->getBase()->IgnoreParenImpCasts());
       }
+      return path;
+    }
 
-      if (OMPAtomicDirective * OMPAD = dyn_cast<OMPAtomicDirective>(OMPED)) {
-
-	std::string snippet = std::string();
-	if (ClDCSnippet == true)
-          snippet = getSourceSnippet(OMPAD->getInnermostCapturedStmt()->getSourceRange(), true, true);
-/*
-        llvm::raw_string_ostream outstream(snippet);
-        //body->printPretty(outstream, NULL, PrintingPolicy(lo));
-        OMPAD->getInnermostCapturedStmt()->dump(outstream, *astContext);
-*/
-        if (OMPAD->getNumClauses() > 0) {
-	  if (isa<OMPCaptureClause>(OMPED->getClause(0)))
-            insertStmtDirectives(OMPAD, "atomic capture", snippet, clauses);
-	  else if (isa<OMPWriteClause>(OMPED->getClause(0)))
-            insertStmtDirectives(OMPAD, "atomic write", snippet, clauses);
-	  else if (isa<OMPReadClause>(OMPED->getClause(0)))
-            insertStmtDirectives(OMPAD, "atomic read", snippet, clauses);
-	  else if (isa<OMPUpdateClause>(OMPED->getClause(0)))
-            insertStmtDirectives(OMPAD, "atomic update", snippet, clauses);
-	}
-	else
-	  insertStmtDirectives(OMPAD, "atomic", snippet, clauses);
+    /*walk the address computation of an element whose field is accessed: the element
+     * itself is not loaded, but its subscripts and pointers are*/
+    void collectElementAddress(Expr *ex, vector<MemAccess> & accesses) {
+      ex = ex->IgnoreParens();
+      if (ArraySubscriptExpr *ASExp = dyn_cast<ArraySubscriptExpr>(ex)) {
+        collectMemAccesses(ASExp->getBase(), true, false, accesses);
+        collectMemAccesses(ASExp->getIdx(), true, false, accesses);
+        return;
+      }
+      if (MemberExpr *MEx = dyn_cast<MemberExpr>(ex)) {
+        if (!MEx->isArrow()) {
+          collectElementAddress(MEx->getBase(), accesses);
+          return;
+        }
       }
+      collectMemAccesses(ex, true, false, accesses);
+    }
 
-      clauses["pragma type"] = classifyPragma(OMPED, (clauses.count("parallel") > 0) == true);
+    void addMemAccess(Expr *ex, bool isRead, bool isWrite, vector<MemAccess> & accesses) {
+      MemAccess access;
+      access.expr = ex;
+      access.base = getAccessBase(ex);
+      access.isRead = isRead;
+      access.isWrite = isWrite;
+      access.bytes = getTypeBytes(ex->getType());
+      access.pattern = "unknown";
+      access.stride = 0;
+      access.reductionOp = std::string();
+      accesses.push_back(access);
+    }
 
-      if (isa<OMPTargetDataDirective>(OMPED) ||
-           isa<OMPTargetEnterDataDirective>(OMPED) ||
-           isa<OMPTargetExitDataDirective>(OMPED))
-	 clauses["offload"] = "false";
+    /*walk a statement collecting its memory accesses (array elements and pointer
+     * dereferences). Reads and writes are told apart by the context the access
+     * appears in: left side of assignments, increments, etc*/
+    void collectMemAccesses(Stmt *st, bool isRead, bool isWrite, vector<MemAccess> & accesses) {
+      if (!st)
+        return;
 
-      for (int i = 0, ie = OMPED->getNumClauses(); i != ie; i++)
-        ClassifyClause(OMPED->getClause(i), clauses);
-    
-      for (int i = 0, ie = nodes_list.size(); i != ie; i++) {
-        if (OMPOrderedDirective *OMPOD = dyn_cast<OMPOrderedDirective>(nodes_list[i]))
-	  associateEachLoopInside(OMPOD, clauses);
-	if (OMPAtomicDirective *OMPAD = dyn_cast<OMPAtomicDirective>(nodes_list[i]))
-	  associateEachLoopInside(OMPAD, clauses);
+      if (CapturedStmt *CPTSt = dyn_cast<CapturedStmt>(st)) {
+        collectMemAccesses(CPTSt->getCapturedStmt(), true, false, accesses);
+        return;
       }
+      if (ParenExpr *PEx = dyn_cast<ParenExpr>(st)) {
+        collectMemAccesses(PEx->getSubExpr(), isRead, isWrite, accesses);
+        return;
+      }
+      if (BinaryOperator *biop = dyn_cast<BinaryOperator>(st)) {
+        if (biop->isAssignmentOp()) {
+          /*associative updates of an element are tagged with their reduction operator*/
+          Expr *target = biop->getLHS()->IgnoreParens();
+          std::string op = getReductionOp(biop);
+          int first = accesses.size();
+          collectMemAccesses(biop->getRHS(), true, false, accesses);
+          for (int i = first, ie = accesses.size(); i < ie && !op.empty(); i++)
+            if (isSameLValue(accesses[i].expr, target))
+              accesses[i].reductionOp = op;
 
-      /*we need do associate clauses for:
-       * - collapsed loops
-       * - target directives
-       * - parallel */
-      if ((clauses.count("collapse") != 0) ||
-          (clauses.count("offload") != 0) ||
-	  (clauses.count("parallel") != 0) ||
-	  (isa<OMPTargetDataDirective>(OMPED) ||
-           isa<OMPTargetEnterDataDirective>(OMPED) ||
-           isa<OMPTargetExitDataDirective>(OMPED))) {
-
-	if (clauses.count("collapse") != 0)
-          CreateLoopDirectiveNode(OMPED, clauses);
+          first = accesses.size();
+          collectMemAccesses(biop->getLHS(), biop->isCompoundAssignmentOp(), true, accesses);
+          if ((int) accesses.size() > first && accesses[first].expr == target)
+            accesses[first].reductionOp = op;
+          return;
+        }
+      }
+      if (UnaryOperator *Uop = dyn_cast<UnaryOperator>(st)) {
+        if (Uop->isIncrementDecrementOp()) {
+          int first = accesses.size();
+          collectMemAccesses(Uop->getSubExpr(), true, true, accesses);
+          if ((int) accesses.size() > first && accesses[first].expr == Uop->getSubExpr()->IgnoreParens())
+            accesses[first].reductionOp = "+";
+          return;
+        }
+        /*taking an address does not touch memory, but the subscripts do*/
+        if (Uop->getOpcode() == UO_AddrOf) {
+          if (ArraySubscriptExpr *ASExp = dyn_cast<ArraySubscriptExpr>(Uop->getSubExpr()->IgnoreParens())) {
+            collectMemAccesses(ASExp->getBase(), true, false, accesses);
+            collectMemAccesses(ASExp->getIdx(), true, false, accesses);
+            return;
+          }
+        }
+        if (Uop->getOpcode() == UO_Deref) {
+          addMemAccess(Uop, isRead, isWrite, accesses);
+          collectMemAccesses(Uop->getSubExpr(), true, false, accesses);
+          return;
+        }
+      }
+      if (MemberExpr *MEx = dyn_cast<MemberExpr>(st)) {
+        if (isElementField(MEx)) {
+          if (!MEx->getType()->isArrayType() && !MEx->getType()->isRecordType())
+            addMemAccess(MEx, isRead, isWrite, accesses);
+          if (MEx->isArrow())
+            collectMemAccesses(MEx->getBase(), true, false, accesses);
+          else
+            collectElementAddress(MEx->getBase(), accesses);
+          return;
+        }
+      }
+      if (ArraySubscriptExpr *ASExp = dyn_cast<ArraySubscriptExpr>(st)) {
+        /*a[i] in a[i][j] only computes an address*/
+        if (!ASExp->getType()->isArrayType())
+          addMemAccess(ASExp, isRead, isWrite, accesses);
+        collectMemAccesses(ASExp->getBase(), true, false, accesses);
+        collectMemAccesses(ASExp->getIdx(), true, false, accesses);
+        return;
+      }
 
-        for (int i = 0, ie = nodes_list.size(); i != ie; i++) {
-	  if (currFile.visited.count(nodes_list[i]) != 0) 
-	    continue;
+      for (auto I = st->child_begin(), IE = st->child_end(); I != IE; I++)
+        collectMemAccesses(*I, true, false, accesses);
+    }
 
-          if (clauses.count("collapse") != 0) {
-            if (isa<DoStmt>(nodes_list[i]) || isa<ForStmt>(nodes_list[i]) || isa<WhileStmt>(nodes_list[i])) {
-              clauses["collapse"] = std::to_string(std::stoi(clauses["collapse"]) - 1);
-	      CreateLoopDirectiveNode(nodes_list[i], clauses);
-	      if (clauses["collapse"] == "1")
-		break;      
-	    }
-	  }
+    /*estimate the floating point operations and the bytes moved by one iteration
+     * of a loop body. Scalars are assumed to live in registers, nested loops are
+     * counted once and calls are not costed*/
+    void estimateLoopCost(Stmt *body, LoopCost & cost) {
+      cost.flops = 0;
+      cost.bytesLoaded = 0;
+      cost.bytesStored = 0;
 
-	  if (OMPExecutableDirective *OMPEN = dyn_cast<OMPExecutableDirective>(nodes_list[i])) {
-            if (OMPLoopDirective *OMPLD = dyn_cast<OMPLoopDirective>(OMPEN)) {
-              associateEachLoopInside(OMPLD, clauses);
-            }
-	    else if (OMPTargetDataDirective *OMPTD = dyn_cast<OMPTargetDataDirective>(OMPEN)) {
-              associateEachLoopInside(OMPED, clauses); 
-	    }
-	    else if (OMPParallelDirective *OMPPD = dyn_cast<OMPParallelDirective>(OMPEN)) {
-              associateEachLoopInside(OMPPD, clauses);
-            }
-	    else if (OMPTargetDirective *OMPTD = dyn_cast<OMPTargetDirective>(OMPEN)) {
-      	      associateEachLoopInside(OMPTD, clauses);
-	    }
-	  }
+      vector<Stmt*> nodes_list;
+      visitNodes(body, nodes_list);
+      for (int i = 0, ie = nodes_list.size(); i != ie; i++) {
+        BinaryOperator *biop = dyn_cast<BinaryOperator>(nodes_list[i]);
+        if (!biop || !biop->getType()->isRealFloatingType())
+          continue;
+        switch (biop->getOpcode()) {
+          case BO_Add:
+          case BO_Sub:
+          case BO_Mul:
+          case BO_Div:
+          case BO_AddAssign:
+          case BO_SubAssign:
+          case BO_MulAssign:
+          case BO_DivAssign:
+            cost.flops++;
+            break;
+          default:
+            break;
         }
       }
 
-      if (OMPLoopDirective *OMPLD = dyn_cast<OMPLoopDirective>(OMPED)) {
-        CreateLoopDirectiveNode(OMPED, clauses);
+      vector<MemAccess> accesses;
+      collectMemAccesses(body, true, false, accesses);
+      for (int i = 0, ie = accesses.size(); i != ie; i++) {
+        if (accesses[i].isRead)
+          cost.bytesLoaded += accesses[i].bytes;
+        if (accesses[i].isWrite)
+          cost.bytesStored += accesses[i].bytes;
       }
     }
 
-    /*Populate a map with the defined lines, to do that, we consider everything inside a statment as
-     * a vector of characters, then we define new ids whenever we find the token ";".
-     * The goal is be able to recover relative positions to statments when necessary, for example,
-     * instructions inside a loop */
-    void recoverCodeSnippetsID(Stmt *st, map<Stmt*, long long int> & mapped_statments, long long int loopID) {
-      string snippet = getSourceSnippet(st->getSourceRange(), true, false);
-/*
-      string snippet;
-      llvm::raw_string_ostream outstream(snippet);
-      //body->printPretty(outstream, NULL, PrintingPolicy(lo));
-      st->dump(outstream, *astContext);
-*/
-      // The separator ref vector have the following format:
-      // <line, column>, where that is the position of the character ';' in the source code
-      // and the position of the vector is the relative id;
-      vector<pair<int, int> > separator_ref;
-      int line = 0;
-      int column = 0;
-      for (int i = 0, ie = snippet.size(); i < ie; i++) {
-	// Store the positions with the character ';'
-        if (snippet[i] == ';')
-	  separator_ref.push_back(make_pair(line, column));
-	column++;
-	if (snippet[i] == '\n') {
-	  line++;
-	  column = 0;
-	}
+    /*format a floating point value for the Json file*/
+    std::string doubleToString(double value) {
+      std::string str;
+      llvm::raw_string_ostream outstream(str);
+      outstream << llvm::format("%.3f", value);
+      return outstream.str();
+    }
+
+    /*classify a loop in the roofline model of the machine description: loops whose
+     * arithmetic intensity (flops per byte) is below the ridge point of the machine
+     * are limited by memory bandwidth, the others by the floating point peak*/
+    std::string getRooflineInfo(LoopCost & cost) {
+      unsigned int bytes = cost.bytesLoaded + cost.bytesStored;
+      std::string info = std::string();
+
+      if (bytes == 0) {
+        info += "\"arithmetic intensity\":\"inf\",\n";
+        info += "\"attainable gflops\":\"" + doubleToString(machine.peakGflops) + "\",\n";
+        info += "\"roofline bound\":\"" + std::string((cost.flops > 0) ? "compute" : "unknown") + "\",\n";
+        return info;
       }
 
-      if (snippet[(snippet.size() - 1)] != ';')
-        separator_ref.push_back(make_pair(line, column));
+      double intensity = (double) cost.flops / bytes;
+      double ridge = machine.peakGflops / machine.bandwidthGBs;
+      double attainable = std::min(machine.peakGflops, intensity * machine.bandwidthGBs);
+      info += "\"arithmetic intensity\":\"" + doubleToString(intensity) + "\",\n";
+      info += "\"attainable gflops\":\"" + doubleToString(attainable) + "\",\n";
+      info += "\"roofline bound\":\"" + std::string((intensity < ridge) ? "memory" : "compute") + "\",\n";
+      return info;
+    }
 
-      vector<Stmt*> nodes_list;
-      visitNodes(st, nodes_list);
-      for (int i = 0, ie = nodes_list.size(); i != ie; i++) {
-        FullSourceLoc StartLocation = astContext->getFullLoc(nodes_list[i]->getBeginLoc());
-        FullSourceLoc EndLocation = astContext->getFullLoc(nodes_list[i]->getEndLoc());
-	if (!StartLocation.isValid() || !EndLocation.isValid()) 
-	  continue;
+    /*recover the source string of an expression, escaped to be used in the Json file*/
+    std::string exprToString(Expr *ex) {
+      std::string str;
+      llvm::raw_string_ostream outstream(str);
+      ex->IgnoreImpCasts()->printPretty(outstream, nullptr, PrintingPolicy(astContext->getLangOpts()));
+      outstream.flush();
+      str = replace_all(str, "\\", "\\\\");
+      return replace_all(str, "\"", "\\\"");
+    }
 
-	int line  = EndLocation.getSpellingLineNumber();
-        int column = EndLocation.getSpellingColumnNumber();
+    /*fold an integer expression into a constant, if possible*/
+    bool evaluateInt(Expr *ex, long long int & value) {
+      Expr::EvalResult result;
+      if (!ex || ex->isValueDependent() || !ex->EvaluateAsInt(result, *astContext))
+        return false;
+      value = result.Val.getInt().getExtValue();
+      return true;
+    }
 
-	mapped_statments[nodes_list[i]] = -1;
-	for (int j = 0, je = separator_ref.size(); j != je; j++) {
-          if (separator_ref[i].first == line) {
-            if (separator_ref[i].second >= column) {
-              mapped_statments[nodes_list[i]] = j + 1;
-	      break;
-	    }
-	  }
-	  else if (separator_ref[i].first > line) {
-            mapped_statments[nodes_list[i]] = j + 1;
-	    break;
-	  }
-	}
-	if (mapped_statments[nodes_list[i]] == -1)
-	  mapped_statments[nodes_list[i]] = separator_ref.size();
+    /*return the variable referenced by an expression like "i" or "(int) i"*/
+    VarDecl *getReferencedVar(Expr *ex) {
+      if (!ex)
+        return nullptr;
+      if (DeclRefExpr *DRex = dyn_cast<DeclRefExpr>(ex->IgnoreParenImpCasts()))
+        return dyn_cast<VarDecl>(DRex->getDecl());
+      return nullptr;
+    }
 
-	// Associate the statment with a relative position. Provides facilities to recover the relative position
-	// after this process
-	struct InputFile& currFile = FileStack.top();
-	currFile.loopInstID[nodes_list[i]].filename = currFile.filename;
-	string functionName = currFile.mapFunctionName[nodes_list[i]];
-	currFile.loopInstID[nodes_list[i]].functionName = functionName;
-	currFile.loopInstID[nodes_list[i]].functionLoopID = loopID;
-        currFile.loopInstID[nodes_list[i]].loopInstructionID = mapped_statments[nodes_list[i]];
-      }
+    /*wrap a non trivial expression string in parenthesis*/
+    std::string parenthesize(std::string str) {
+      if (str.find(' ') == std::string::npos)
+        return str;
+      return "(" + str + ")";
     }
 
-    /*visits all nodes of type decl*/
-    virtual bool VisitDecl(Decl *D) {
-	struct InputFile& currFile = FileStack.top();
-	if (FunctionDecl *FD = dyn_cast<FunctionDecl>(D)) {
-      	  if (FD->doesThisDeclarationHaveABody()) {
-	    const SourceManager& mng = astContext->getSourceManager();
-            if (astContext->getSourceManager().isInSystemHeader(D->getLocation())) {
-              return true;
-            }
+    /*extract the iteration space of a canonical for loop ("init; var op bound; incr").
+     * Returns false when the loop doesn't have that shape*/
+    bool getLoopBounds(Stmt *st, LoopBounds & bounds) {
+      ForStmt *fstmt = dyn_cast_or_null<ForStmt>(st);
+      if (!fstmt || !fstmt->getInc() || !fstmt->getCond())
+        return false;
 
-            string filename = mng.getFilename(D->getBeginLoc()).str();
+      /*induction variable and step, from the increment*/
+      Expr *stepExpr = nullptr;
+      bool negativeStep = false;
+      bounds.inductionVar = nullptr;
+      bounds.stepConst = true;
+      bounds.stepValue = 1;
+      Expr *inc = fstmt->getInc()->IgnoreParens();
+      if (UnaryOperator *unop = dyn_cast<UnaryOperator>(inc)) {
+        if (!unop->isIncrementDecrementOp())
+          return false;
+        bounds.inductionVar = getReferencedVar(unop->getSubExpr());
+        negativeStep = unop->isDecrementOp();
+      }
+      else if (BinaryOperator *biop = dyn_cast<BinaryOperator>(inc)) {
+        bounds.inductionVar = getReferencedVar(biop->getLHS());
+        if (biop->getOpcode() == BO_AddAssign || biop->getOpcode() == BO_SubAssign) {
+          stepExpr = biop->getRHS();
+          negativeStep = (biop->getOpcode() == BO_SubAssign);
+        }
+        else if (biop->getOpcode() == BO_Assign) {
+          /*i = i + s, i = s + i, i = i - s*/
+          BinaryOperator *rhs = dyn_cast<BinaryOperator>(biop->getRHS()->IgnoreParenImpCasts());
+          if (!rhs || !bounds.inductionVar)
+            return false;
+          if (rhs->getOpcode() == BO_Add && getReferencedVar(rhs->getLHS()) == bounds.inductionVar)
+            stepExpr = rhs->getRHS();
+          else if (rhs->getOpcode() == BO_Add && getReferencedVar(rhs->getRHS()) == bounds.inductionVar)
+            stepExpr = rhs->getLHS();
+          else if (rhs->getOpcode() == BO_Sub && getReferencedVar(rhs->getLHS()) == bounds.inductionVar) {
+            stepExpr = rhs->getRHS();
+            negativeStep = true;
+          }
+          else
+            return false;
+        }
+        else
+          return false;
+      }
+      if (!bounds.inductionVar)
+        return false;
+
+      if (stepExpr) {
+        bounds.stepConst = evaluateInt(stepExpr, bounds.stepValue);
+        bounds.step = bounds.stepConst ? to_string(bounds.stepValue) : exprToString(stepExpr);
+      }
+      else
+        bounds.step = "1";
+      if (negativeStep) {
+        bounds.stepValue = -bounds.stepValue;
+        bounds.step = bounds.stepConst ? to_string(bounds.stepValue) : "-" + parenthesize(bounds.step);
+      }
+      /*a constant step overrides the direction given by the operator (i += -1)*/
+      if (bounds.stepConst) {
+        if (bounds.stepValue == 0)
+          return false;
+        negativeStep = (bounds.stepValue < 0);
+      }
+
+      /*lower bound, from the initialization*/
+      bounds.lowerExpr = nullptr;
+      if (DeclStmt *DCst = dyn_cast_or_null<DeclStmt>(fstmt->getInit())) {
+        if (DCst->isSingleDecl() && DCst->getSingleDecl() == bounds.inductionVar)
+          bounds.lowerExpr = bounds.inductionVar->getInit();
+      }
+      else if (BinaryOperator *biop = dyn_cast_or_null<BinaryOperator>(fstmt->getInit())) {
+        if (biop->getOpcode() == BO_Assign && getReferencedVar(biop->getLHS()) == bounds.inductionVar)
+          bounds.lowerExpr = biop->getRHS();
+      }
+      if (!bounds.lowerExpr)
+        return false;
+
+      /*upper bound, from the condition. Normalized as "var op bound"*/
+      BinaryOperator *cond = dyn_cast<BinaryOperator>(fstmt->getCond()->IgnoreParenImpCasts());
+      if (!cond || !cond->isComparisonOp())
+        return false;
+      bounds.comparison = cond->getOpcode();
+      if (getReferencedVar(cond->getLHS()) == bounds.inductionVar)
+        bounds.upperExpr = cond->getRHS();
+      else if (getReferencedVar(cond->getRHS()) == bounds.inductionVar) {
+        bounds.upperExpr = cond->getLHS();
+        bounds.comparison = BinaryOperator::reverseComparisonOp(bounds.comparison);
+      }
+      else
+        return false;
+
+      bounds.lowerConst = evaluateInt(bounds.lowerExpr, bounds.lowerValue);
+      bounds.upperConst = evaluateInt(bounds.upperExpr, bounds.upperValue);
+      bounds.lower = bounds.lowerConst ? to_string(bounds.lowerValue) : exprToString(bounds.lowerExpr);
+      bounds.upper = bounds.upperConst ? to_string(bounds.upperValue) : exprToString(bounds.upperExpr);
+
+      computeTripCount(bounds, negativeStep);
+      return true;
+    }
+
+    /*trip count of a normalized loop: ceil(distance / |step|), where the distance
+     * depends on the direction of the loop and on the comparison being inclusive*/
+    void computeTripCount(LoopBounds & bounds, bool negativeStep) {
+      BinaryOperator::Opcode op = bounds.comparison;
+      bool increasing = (op == BO_LT || op == BO_LE);
+      bool decreasing = (op == BO_GT || op == BO_GE);
+      bool inclusive = (op == BO_LE || op == BO_GE);
+      bounds.tripConst = false;
+      bounds.tripValue = 0;
+
+      if ((increasing && negativeStep) || (decreasing && !negativeStep) || (!increasing && !decreasing && op != BO_NE)) {
+        bounds.tripCount = "unknown";
+        return;
+      }
+
+      if (bounds.lowerConst && bounds.upperConst && bounds.stepConst) {
+        long long int stepSize = negativeStep ? -bounds.stepValue : bounds.stepValue;
+        long long int distance = negativeStep ? (bounds.lowerValue - bounds.upperValue) : (bounds.upperValue - bounds.lowerValue);
+        if (inclusive)
+          distance++;
+        if (op == BO_NE && (distance % stepSize) != 0) {
+          bounds.tripCount = "unknown";
+          return;
+        }
+        bounds.tripConst = true;
+        bounds.tripValue = (distance <= 0) ? 0 : (distance + stepSize - 1) / stepSize;
+        bounds.tripCount = to_string(bounds.tripValue);
+        return;
+      }
+
+      std::string from = negativeStep ? bounds.upper : bounds.lower;
+      std::string to = negativeStep ? bounds.lower : bounds.upper;
+      std::string distance = parenthesize(to);
+      if (from != "0")
+        distance += " - " + parenthesize(from);
+      if (inclusive)
+        distance += " + 1";
+
+      std::string stepSize = bounds.stepConst ? to_string(negativeStep ? -bounds.stepValue : bounds.stepValue) : bounds.step;
+      if (negativeStep && !bounds.stepConst)
+        stepSize = stepSize.substr(1);
+      if (stepSize == "1")
+        bounds.tripCount = distance;
+      else
+        bounds.tripCount = "(" + distance + " + " + stepSize + " - 1) / " + stepSize;
+    }
+
+    /*Json fields describing the iteration space of a loop*/
+    std::string getLoopBoundsInfo(Stmt *st) {
+      LoopBounds bounds;
+      if (!getLoopBounds(st, bounds))
+        return ",\n\"trip count\":\"unknown\"";
+
+      std::string info = std::string();
+      info += ",\n\"lower bound\":\"" + bounds.lower + "\"";
+      info += ",\n\"upper bound\":\"" + bounds.upper + "\"";
+      info += ",\n\"bound comparison\":\"" + BinaryOperator::getOpcodeStr(bounds.comparison).str() + "\"";
+      info += ",\n\"step\":\"" + bounds.step + "\"";
+      info += ",\n\"trip count\":\"" + bounds.tripCount + "\"";
+      info += ",\n\"constant trip count\":\"" + std::string(bounds.tripConst ? "true" : "false") + "\"";
+      return info;
+    }
+
+    /*body of a do, for or while loop*/
+    Stmt *getLoopBody(Stmt *st) {
+      if (ForStmt *forst = dyn_cast<ForStmt>(st))
+        return forst->getBody();
+      if (DoStmt *dost = dyn_cast<DoStmt>(st))
+        return dost->getBody();
+      if (WhileStmt *whst = dyn_cast<WhileStmt>(st))
+        return whst->getBody();
+      return nullptr;
+    }
+
+    /*collect the scalar variables that change value inside a loop body: the ones
+     * assigned, incremented or declared there. Induction variables of nested loops
+     * are left out, as they are the other dimensions of the iteration space*/
+    void collectWrittenVars(Stmt *body, set<VarDecl*> & written, set<VarDecl*> & innerInductionVars) {
+      vector<Stmt*> nodes_list;
+      visitNodes(body, nodes_list);
+      for (int i = 0, ie = nodes_list.size(); i != ie; i++) {
+        if (BinaryOperator *biop = dyn_cast<BinaryOperator>(nodes_list[i])) {
+          if (biop->isAssignmentOp() && getReferencedVar(biop->getLHS()))
+            written.insert(getReferencedVar(biop->getLHS()));
+        }
+        else if (UnaryOperator *unop = dyn_cast<UnaryOperator>(nodes_list[i])) {
+          if (unop->isIncrementDecrementOp() && getReferencedVar(unop->getSubExpr()))
+            written.insert(getReferencedVar(unop->getSubExpr()));
+        }
+        else if (DeclStmt *DCst = dyn_cast<DeclStmt>(nodes_list[i])) {
+          for (auto I = DCst->decl_begin(), IE = DCst->decl_end(); I != IE; I++)
+            if (VarDecl *VD = dyn_cast<VarDecl>(*I))
+              written.insert(VD);
+        }
+        else if (ForStmt *fstmt = dyn_cast<ForStmt>(nodes_list[i])) {
+          LoopBounds bounds;
+          if (getLoopBounds(fstmt, bounds))
+            innerInductionVars.insert(bounds.inductionVar);
+        }
+      }
+      for (set<VarDecl*>::iterator I = innerInductionVars.begin(), IE = innerInductionVars.end(); I != IE; I++)
+        written.erase(*I);
+    }
+
+    /*check if an expression reads the given variable or any of the written ones*/
+    bool dependsOnVars(Stmt *st, VarDecl *var, set<VarDecl*> & written) {
+      vector<Stmt*> nodes_list;
+      visitNodes(st, nodes_list);
+      for (int i = 0, ie = nodes_list.size(); i != ie; i++) {
+        if (DeclRefExpr *DRex = dyn_cast<DeclRefExpr>(nodes_list[i])) {
+          VarDecl *VD = dyn_cast<VarDecl>(DRex->getDecl());
+          if (VD && (VD == var || written.count(VD) != 0))
+            return true;
+        }
+      }
+      return false;
+    }
+
+    /*check if an expression loads from memory at an address that changes with the
+     * given variable, as idx[i] in a[idx[i]]*/
+    bool hasDependentLoad(Stmt *st, VarDecl *var, set<VarDecl*> & written) {
+      vector<Stmt*> nodes_list;
+      visitNodes(st, nodes_list);
+      for (int i = 0, ie = nodes_list.size(); i != ie; i++) {
+        UnaryOperator *unop = dyn_cast<UnaryOperator>(nodes_list[i]);
+        if (isa<ArraySubscriptExpr>(nodes_list[i]) || (unop && unop->getOpcode() == UO_Deref))
+          if (dependsOnVars(nodes_list[i], var, written))
+            return true;
+      }
+      return false;
+    }
+
+    /*compute the coefficient of a variable in an affine expression (c * var + invariant
+     * terms). The coefficient is flagged as symbolic when it isn't a constant, as in
+     * n * var. Returns false when the expression isn't affine*/
+    bool getAffineCoefficient(Expr *ex, VarDecl *var, set<VarDecl*> & written, long long int & coefficient, bool & symbolic) {
+      ex = ex->IgnoreParenCasts();
+      coefficient = 0;
+      symbolic = false;
+      if (!dependsOnVars(ex, var, written))
+        return true;
+      if (var && getReferencedVar(ex) == var) {
+        coefficient = 1;
+        return true;
+      }
+
+      long long int lcoef, rcoef, value;
+      bool lsym, rsym;
+      if (BinaryOperator *biop = dyn_cast<BinaryOperator>(ex)) {
+        Expr *lhs = biop->getLHS();
+        Expr *rhs = biop->getRHS();
+        switch (biop->getOpcode()) {
+          case BO_Add:
+          case BO_Sub:
+            if (!getAffineCoefficient(lhs, var, written, lcoef, lsym) ||
+                !getAffineCoefficient(rhs, var, written, rcoef, rsym))
+              return false;
+            coefficient = (biop->getOpcode() == BO_Add) ? (lcoef + rcoef) : (lcoef - rcoef);
+            symbolic = lsym || rsym;
+            return true;
+          case BO_Mul:
+            if (dependsOnVars(lhs, var, written))
+              std::swap(lhs, rhs);
+            if (dependsOnVars(lhs, var, written) || !getAffineCoefficient(rhs, var, written, rcoef, rsym))
+              return false;
+            if (evaluateInt(lhs, value)) {
+              coefficient = rcoef * value;
+              symbolic = rsym;
+            }
+            else {
+              coefficient = rcoef;
+              symbolic = true;
+            }
+            return true;
+          case BO_Shl:
+            if (!evaluateInt(rhs, value) || !getAffineCoefficient(lhs, var, written, lcoef, lsym))
+              return false;
+            coefficient = lcoef << value;
+            symbolic = lsym;
+            return true;
+          default:
+            return false;
+        }
+      }
+      if (UnaryOperator *unop = dyn_cast<UnaryOperator>(ex)) {
+        if (unop->getOpcode() != UO_Minus && unop->getOpcode() != UO_Plus)
+          return false;
+        if (!getAffineCoefficient(unop->getSubExpr(), var, written, coefficient, symbolic))
+          return false;
+        if (unop->getOpcode() == UO_Minus)
+          coefficient = -coefficient;
+        return true;
+      }
+      return false;
+    }
+
+    /*split an access in its subscripts, innermost dimension first, each one with the
+     * number of elements it skips (a[i][j] in double a[N][M] gives j:1 and i:M, and
+     * a[i].x in an array of structs skips a struct size measured in fields).
+     * A dereference has the pointer expression as its only subscript. Returns the
+     * expression the subscripts are applied to, if any*/
+    Expr *getSubscripts(MemAccess & access, vector<pair<Expr*, long long int> > & subscripts) {
+      Expr *base = nullptr;
+      Expr *cur = access.expr->IgnoreParenImpCasts();
+      /*fields of an element: a[i].x uses the subscripts of a[i], p->x works as *p*/
+      while (MemberExpr *MEx = dyn_cast<MemberExpr>(cur)) {
+        if (MEx->isArrow()) {
+          QualType pointee = MEx->getBase()->getType()->getPointeeType();
+          long long int elements = (access.bytes != 0) ? getTypeBytes(pointee) / access.bytes : 0;
+          subscripts.push_back(make_pair(MEx->getBase(), elements));
+          return nullptr;
+        }
+        cur = MEx->getBase()->IgnoreParenImpCasts();
+      }
+      if (UnaryOperator *unop = dyn_cast<UnaryOperator>(cur))
+        subscripts.push_back(make_pair(unop->getSubExpr(), 1LL));
+      while (ArraySubscriptExpr *ASExp = dyn_cast_or_null<ArraySubscriptExpr>(cur)) {
+        long long int elements = (access.bytes != 0) ? getTypeBytes(ASExp->getType()) / access.bytes : 0;
+        subscripts.push_back(make_pair(ASExp->getIdx(), elements));
+        base = ASExp->getBase()->IgnoreParenImpCasts();
+        cur = base->getType()->isArrayType() ? base : nullptr;
+      }
+      return base;
+    }
+
+    /*classify a memory access by how its address moves when the induction variable
+     * is incremented: unit stride, constant stride, invariant, indirect (gather/scatter
+     * through another array) or unknown. The stride is measured in elements, and left
+     * as 0 for constant strides only known symbolically*/
+    void classifyAccess(MemAccess & access, VarDecl *var, set<VarDecl*> & written) {
+      access.pattern = "unknown";
+      access.stride = 0;
+
+      vector<pair<Expr*, long long int> > subscripts;
+      Expr *base = getSubscripts(access, subscripts);
+
+      if (base && hasDependentLoad(base, var, written)) {
+        access.pattern = "indirect";
+        return;
+      }
+      for (int i = 0, ie = subscripts.size(); i != ie; i++) {
+        if (hasDependentLoad(subscripts[i].first, var, written)) {
+          access.pattern = "indirect";
+          return;
+        }
+      }
+      if (base && dependsOnVars(base, var, written))
+        return;
+
+      bool symbolicStride = false;
+      for (int i = 0, ie = subscripts.size(); i != ie; i++) {
+        long long int coefficient;
+        bool symbolic;
+        if (!getAffineCoefficient(subscripts[i].first, var, written, coefficient, symbolic))
+          return;
+        if (coefficient != 0 && subscripts[i].second == 0)
+          symbolic = true;
+        symbolicStride = symbolicStride || symbolic;
+        access.stride += coefficient * subscripts[i].second;
+      }
+
+      /*a partial sum of the constant coefficients isn't the stride (n*i + i is not 1)*/
+      if (symbolicStride) {
+        access.pattern = "constant stride";
+        access.stride = 0;
+      }
+      else if (access.stride == 0)
+        access.pattern = "invariant";
+      else if (access.stride == 1 || access.stride == -1)
+        access.pattern = "unit stride";
+      else
+        access.pattern = "constant stride";
+    }
+
+    /*Json fields with the number of accesses of each pattern in a loop body, plus the
+     * list of the accesses that are neither unit stride nor invariant*/
+    std::string getAccessPatternInfo(Stmt *st) {
+      Stmt *body = getLoopBody(st);
+      LoopBounds bounds;
+      VarDecl *var = getLoopBounds(st, bounds) ? bounds.inductionVar : nullptr;
+
+      set<VarDecl*> written, innerInductionVars;
+      vector<MemAccess> accesses;
+      collectWrittenVars(body, written, innerInductionVars);
+      written.erase(var);
+      collectMemAccesses(body, true, false, accesses);
+
+      map<string, int> patternCount;
+      std::string irregular = std::string();
+      for (int i = 0, ie = accesses.size(); i != ie; i++) {
+        classifyAccess(accesses[i], var, written);
+        patternCount[accesses[i].pattern]++;
+        if (accesses[i].pattern == "unit stride" || accesses[i].pattern == "invariant")
+          continue;
+        irregular += "\"" + exprToString(accesses[i].expr) + ": " + accesses[i].pattern;
+        if (accesses[i].pattern == "constant stride")
+          irregular += " " + ((accesses[i].stride != 0) ? to_string(accesses[i].stride) : std::string("symbolic"));
+        irregular += "\",";
+      }
+      if (irregular.size() > 0)
+        irregular.erase(irregular.end()-1, irregular.end());
+
+      std::string info = std::string();
+      info += ",\n\"unit stride accesses\":\"" + to_string(patternCount["unit stride"]) + "\"";
+      info += ",\n\"constant stride accesses\":\"" + to_string(patternCount["constant stride"]) + "\"";
+      info += ",\n\"invariant accesses\":\"" + to_string(patternCount["invariant"]) + "\"";
+      info += ",\n\"indirect accesses\":\"" + to_string(patternCount["indirect"]) + "\"";
+      info += ",\n\"unknown accesses\":\"" + to_string(patternCount["unknown"]) + "\"";
+      if (irregular.size() > 0)
+        info += ",\n\"irregular accesses\":[" + irregular + "]";
+      return info;
+    }
+
+    /*list the statements enclosing a statement in its function, innermost first*/
+    void getEnclosingStmts(Stmt *st, vector<Stmt*> & enclosing) {
+      DynTypedNode node = DynTypedNode::create(*st);
+      while (true) {
+        DynTypedNodeList parents = astContext->getParents(node);
+        if (parents.empty())
+          return;
+        node = parents[0];
+        if (node.get<FunctionDecl>())
+          return;
+        if (const Stmt *parent = node.get<Stmt>())
+          enclosing.push_back(const_cast<Stmt*>(parent));
+      }
+    }
+
+    /*check if a statement is part of the region of some OpenMP directive*/
+    bool isInsideDirective(Stmt *st) {
+      vector<Stmt*> enclosing;
+      getEnclosingStmts(st, enclosing);
+      for (int i = 0, ie = enclosing.size(); i != ie; i++)
+        if (isa<OMPExecutableDirective>(enclosing[i]))
+          return true;
+      return false;
+    }
+
+    /*check if a variable is declared inside a statement (so it is private to it)*/
+    bool isDeclaredInside(VarDecl *VD, Stmt *st) {
+      const SourceManager& mng = astContext->getSourceManager();
+      return mng.isPointWithin(VD->getLocation(), st->getBeginLoc(), st->getEndLoc());
+    }
+
+    /*math functions from the C library, known to have no side effects on memory
+     * and to have vector versions in the usual math libraries*/
+    bool isKnownMathFunction(FunctionDecl *FD) {
+      static const set<std::string> mathFunctions = {
+        "sqrt", "cbrt", "exp", "exp2", "expm1", "log", "log2", "log10", "log1p",
+        "pow", "sin", "cos", "tan", "asin", "acos", "atan", "atan2", "sinh",
+        "cosh", "tanh", "erf", "erfc", "fabs", "abs", "floor", "ceil", "round",
+        "trunc", "fmin", "fmax", "fma", "fmod", "hypot", "copysign"};
+      std::string name = FD->getNameAsString();
+      if (mathFunctions.count(name) != 0)
+        return true;
+      /*float versions, as sqrtf*/
+      if (name.size() > 1 && name[name.size() - 1] == 'f')
+        return mathFunctions.count(name.substr(0, name.size() - 1)) != 0;
+      return false;
+    }
+
+    /*join a list of strings as the items of a Json list*/
+    std::string joinJsonList(vector<std::string> & items) {
+      std::string list = std::string();
+      for (int i = 0, ie = items.size(); i != ie; i++)
+        list += ((i == 0) ? "\"" : ",\"") + items[i] + "\"";
+      return list;
+    }
+
+    /*check if two expressions designate the same variable or array element*/
+    bool isSameLValue(Expr *first, Expr *second) {
+      return exprToString(first->IgnoreParenImpCasts()) == exprToString(second->IgnoreParenImpCasts());
+    }
+
+    /*check if an expression reads the variable (or the array) of a target lvalue*/
+    bool usesLValue(Expr *ex, Expr *target) {
+      vector<Stmt*> nodes_list;
+      ValueDecl *base = getAccessBase(target);
+      visitNodes(ex, nodes_list);
+      for (int i = 0, ie = nodes_list.size(); i != ie; i++) {
+        if (DeclRefExpr *DRex = dyn_cast<DeclRefExpr>(nodes_list[i]))
+          if (DRex->getDecl() == base)
+            return true;
+      }
+      return false;
+    }
+
+    /*reduction operator of an update like "s += e", "s = s * e", "a[k] = e + a[k]" or
+     * "s = s > e ? s : e", or an empty string when the assignment isn't an
+     * associative update of its target. Subtractions are reported as "+" reductions*/
+    std::string getReductionOp(BinaryOperator *assign) {
+      Expr *target = assign->getLHS();
+      switch (assign->getOpcode()) {
+        case BO_AddAssign:
+        case BO_SubAssign:
+          return usesLValue(assign->getRHS(), target) ? std::string() : "+";
+        case BO_MulAssign:
+          return usesLValue(assign->getRHS(), target) ? std::string() : "*";
+        case BO_AndAssign:
+          return usesLValue(assign->getRHS(), target) ? std::string() : "&";
+        case BO_OrAssign:
+          return usesLValue(assign->getRHS(), target) ? std::string() : "|";
+        case BO_XorAssign:
+          return usesLValue(assign->getRHS(), target) ? std::string() : "^";
+        case BO_Assign:
+          break;
+        default:
+          return std::string();
+      }
+
+      Expr *rhs = assign->getRHS()->IgnoreParenImpCasts();
+      if (BinaryOperator *biop = dyn_cast<BinaryOperator>(rhs)) {
+        Expr *other = nullptr;
+        std::string op = BinaryOperator::getOpcodeStr(biop->getOpcode()).str();
+        if (isSameLValue(biop->getLHS(), target))
+          other = biop->getRHS();
+        else if (isSameLValue(biop->getRHS(), target) && op != "-")
+          other = biop->getLHS();
+        if (!other || usesLValue(other, target))
+          return std::string();
+        if (op == "-")
+          return "+";
+        if (op == "+" || op == "*" || op == "&" || op == "|" || op == "^" || op == "&&" || op == "||")
+          return op;
+        return std::string();
+      }
+
+      if (ConditionalOperator *CO = dyn_cast<ConditionalOperator>(rhs)) {
+        BinaryOperator *cmp = dyn_cast<BinaryOperator>(CO->getCond()->IgnoreParenImpCasts());
+        if (!cmp || !cmp->isRelationalOp())
+          return std::string();
+        bool same = isSameLValue(CO->getTrueExpr(), cmp->getLHS()) && isSameLValue(CO->getFalseExpr(), cmp->getRHS());
+        bool swapped = isSameLValue(CO->getTrueExpr(), cmp->getRHS()) && isSameLValue(CO->getFalseExpr(), cmp->getLHS());
+        Expr *other = nullptr;
+        if (isSameLValue(cmp->getLHS(), target))
+          other = cmp->getRHS();
+        else if (isSameLValue(cmp->getRHS(), target))
+          other = cmp->getLHS();
+        if ((!same && !swapped) || !other || usesLValue(other, target))
+          return std::string();
+        bool greater = (cmp->getOpcode() == BO_GT || cmp->getOpcode() == BO_GE);
+        return (greater == same) ? "max" : "min";
+      }
+
+      if (CallExpr *CE = dyn_cast<CallExpr>(rhs)) {
+        FunctionDecl *FD = CE->getDirectCallee();
+        if (!FD || CE->getNumArgs() != 2)
+          return std::string();
+        std::string name = FD->getNameAsString();
+        Expr *other = nullptr;
+        if (isSameLValue(CE->getArg(0), target))
+          other = CE->getArg(1);
+        else if (isSameLValue(CE->getArg(1), target))
+          other = CE->getArg(0);
+        if (!other || usesLValue(other, target))
+          return std::string();
+        if (name == "fmax" || name == "fmaxf" || name == "max")
+          return "max";
+        if (name == "fmin" || name == "fminf" || name == "min")
+          return "min";
+      }
+      return std::string();
+    }
+
+    /*walk a statement collecting the reads and writes of scalar variables in evaluation
+     * order. Accesses under if/switch/?:/&&/|| or in the body of nested loops are
+     * flagged as conditional*/
+    void collectScalarAccesses(Stmt *st, bool isRead, bool isWrite, bool conditional, vector<ScalarAccess> & accesses) {
+      if (!st)
+        return;
+
+      if (CapturedStmt *CPTSt = dyn_cast<CapturedStmt>(st)) {
+        collectScalarAccesses(CPTSt->getCapturedStmt(), true, false, conditional, accesses);
+        return;
+      }
+      if (ParenExpr *PEx = dyn_cast<ParenExpr>(st)) {
+        collectScalarAccesses(PEx->getSubExpr(), isRead, isWrite, conditional, accesses);
+        return;
+      }
+      if (DeclRefExpr *DRex = dyn_cast<DeclRefExpr>(st)) {
+        VarDecl *VD = dyn_cast<VarDecl>(DRex->getDecl());
+        if (VD && !VD->getType()->isArrayType()) {
+          ScalarAccess access;
+          access.var = VD;
+          access.ref = DRex;
+          access.isRead = isRead;
+          access.isWrite = isWrite;
+          access.conditional = conditional;
+          access.reductionOp = std::string();
+          accesses.push_back(access);
+        }
+        return;
+      }
+      if (BinaryOperator *biop = dyn_cast<BinaryOperator>(st)) {
+        if (biop->isAssignmentOp()) {
+          VarDecl *var = getReferencedVar(biop->getLHS());
+          std::string op = var ? getReductionOp(biop) : std::string();
+
+          int first = accesses.size();
+          collectScalarAccesses(biop->getRHS(), true, false, conditional, accesses);
+          for (int i = first, ie = accesses.size(); i < ie && !op.empty(); i++)
+            if (accesses[i].var == var)
+              accesses[i].reductionOp = op;
+
+          first = accesses.size();
+          collectScalarAccesses(biop->getLHS(), biop->isCompoundAssignmentOp(), true, conditional, accesses);
+          if (var && (int) accesses.size() > first)
+            accesses.back().reductionOp = op;
+          return;
+        }
+        if (biop->getOpcode() == BO_LAnd || biop->getOpcode() == BO_LOr) {
+          collectScalarAccesses(biop->getLHS(), true, false, conditional, accesses);
+          collectScalarAccesses(biop->getRHS(), true, false, true, accesses);
+          return;
+        }
+      }
+      if (UnaryOperator *unop = dyn_cast<UnaryOperator>(st)) {
+        if (unop->isIncrementDecrementOp()) {
+          int first = accesses.size();
+          collectScalarAccesses(unop->getSubExpr(), true, true, conditional, accesses);
+          if (getReferencedVar(unop->getSubExpr()) && (int) accesses.size() > first)
+            accesses.back().reductionOp = "+";
+          return;
+        }
+        /*the address escapes, so the variable may be read and written through it*/
+        if (unop->getOpcode() == UO_AddrOf) {
+          collectScalarAccesses(unop->getSubExpr(), true, true, conditional, accesses);
+          return;
+        }
+      }
+      if (IfStmt *IfSt = dyn_cast<IfStmt>(st)) {
+        collectScalarAccesses(IfSt->getInit(), true, false, conditional, accesses);
+        collectScalarAccesses(IfSt->getCond(), true, false, conditional, accesses);
+        collectScalarAccesses(IfSt->getThen(), true, false, true, accesses);
+        collectScalarAccesses(IfSt->getElse(), true, false, true, accesses);
+        return;
+      }
+      if (ConditionalOperator *CO = dyn_cast<ConditionalOperator>(st)) {
+        collectScalarAccesses(CO->getCond(), true, false, conditional, accesses);
+        collectScalarAccesses(CO->getTrueExpr(), true, false, true, accesses);
+        collectScalarAccesses(CO->getFalseExpr(), true, false, true, accesses);
+        return;
+      }
+      if (ForStmt *fstmt = dyn_cast<ForStmt>(st)) {
+        collectScalarAccesses(fstmt->getInit(), true, false, conditional, accesses);
+        collectScalarAccesses(fstmt->getCond(), true, false, conditional, accesses);
+        collectScalarAccesses(fstmt->getBody(), true, false, true, accesses);
+        collectScalarAccesses(fstmt->getInc(), true, false, true, accesses);
+        return;
+      }
+      if (WhileStmt *whst = dyn_cast<WhileStmt>(st)) {
+        collectScalarAccesses(whst->getCond(), true, false, conditional, accesses);
+        collectScalarAccesses(whst->getBody(), true, false, true, accesses);
+        return;
+      }
+      if (SwitchStmt *swst = dyn_cast<SwitchStmt>(st)) {
+        collectScalarAccesses(swst->getCond(), true, false, conditional, accesses);
+        collectScalarAccesses(swst->getBody(), true, false, true, accesses);
+        return;
+      }
+
+      for (auto I = st->child_begin(), IE = st->child_end(); I != IE; I++)
+        collectScalarAccesses(*I, true, false, conditional, accesses);
+    }
+
+    /*decompose a subscript in its affine terms, multiplied by factor. Loop invariant
+     * terms that can't be folded are kept as strings*/
+    bool collectAffineTerms(Expr *ex, long long int factor, VarDecl *var, set<VarDecl*> & written,
+                            set<VarDecl*> & innerVars, AffineSubscript & subscript, vector<std::string> & terms) {
+      ex = ex->IgnoreParenCasts();
+      long long int value;
+      if (evaluateInt(ex, value)) {
+        subscript.offset += factor * value;
+        return true;
+      }
+      if (var && getReferencedVar(ex) == var) {
+        subscript.coefficient += factor;
+        return true;
+      }
+      if (BinaryOperator *biop = dyn_cast<BinaryOperator>(ex)) {
+        if (biop->getOpcode() == BO_Add || biop->getOpcode() == BO_Sub) {
+          long long int rfactor = (biop->getOpcode() == BO_Add) ? factor : -factor;
+          return collectAffineTerms(biop->getLHS(), factor, var, written, innerVars, subscript, terms) &&
+                 collectAffineTerms(biop->getRHS(), rfactor, var, written, innerVars, subscript, terms);
+        }
+        if (biop->getOpcode() == BO_Mul) {
+          if (evaluateInt(biop->getLHS(), value))
+            return collectAffineTerms(biop->getRHS(), factor * value, var, written, innerVars, subscript, terms);
+          if (evaluateInt(biop->getRHS(), value))
+            return collectAffineTerms(biop->getLHS(), factor * value, var, written, innerVars, subscript, terms);
+        }
+      }
+      if (UnaryOperator *unop = dyn_cast<UnaryOperator>(ex)) {
+        if (unop->getOpcode() == UO_Minus)
+          return collectAffineTerms(unop->getSubExpr(), -factor, var, written, innerVars, subscript, terms);
+        if (unop->getOpcode() == UO_Plus)
+          return collectAffineTerms(unop->getSubExpr(), factor, var, written, innerVars, subscript, terms);
+      }
+      if (dependsOnVars(ex, var, written))
+        return false;
+      if (dependsOnVars(ex, nullptr, innerVars))
+        subscript.varying = true;
+      terms.push_back(to_string(factor) + "*" + exprToString(ex));
+      return true;
+    }
+
+    /*put a subscript in affine form with respect to the induction variable, if possible*/
+    bool getAffineSubscript(Expr *ex, VarDecl *var, set<VarDecl*> & written, set<VarDecl*> & innerVars, AffineSubscript & subscript) {
+      vector<std::string> terms;
+      subscript.coefficient = 0;
+      subscript.offset = 0;
+      subscript.varying = false;
+      subscript.symbolic = std::string();
+      if (!collectAffineTerms(ex, 1, var, written, innerVars, subscript, terms))
+        return false;
+      std::sort(terms.begin(), terms.end());
+      for (int i = 0, ie = terms.size(); i != ie; i++)
+        subscript.symbolic += terms[i] + " ";
+      return true;
+    }
+
+    long long int gcd(long long int a, long long int b) {
+      a = (a < 0) ? -a : a;
+      b = (b < 0) ? -b : b;
+      while (b != 0) {
+        long long int r = a % b;
+        a = b;
+        b = r;
+      }
+      return a;
+    }
+
+    /*test two accesses to the same array for a dependence carried by the loop, dimension
+     * by dimension: equal coefficients give an exact distance, different ones are
+     * checked with the GCD test and Banerjee bounds. Returns false when the accesses
+     * are proven independent across iterations, otherwise the distance (in values of
+     * the induction variable) is returned when known*/
+    bool testDependence(MemAccess & first, MemAccess & second, VarDecl *var, set<VarDecl*> & written,
+                        set<VarDecl*> & innerVars, LoopBounds & bounds, std::string & distance) {
+      vector<pair<Expr*, long long int> > firstSubs, secondSubs;
+      getSubscripts(first, firstSubs);
+      getSubscripts(second, secondSubs);
+      distance = "unknown";
+      /*different fields of the elements never overlap*/
+      if (getFieldPath(first.expr) != getFieldPath(second.expr))
+        return false;
+      if (firstSubs.size() != secondSubs.size())
+        return true;
+
+      bool fixed = false;
+      bool unknown = false;
+      long long int fixedDistance = 0;
+      for (int k = 0, ke = firstSubs.size(); k != ke; k++) {
+        AffineSubscript a, b;
+        if (!getAffineSubscript(firstSubs[k].first, var, written, innerVars, a) ||
+            !getAffineSubscript(secondSubs[k].first, var, written, innerVars, b) ||
+            a.symbolic != b.symbolic) {
+          unknown = true;
+          continue;
+        }
+        /*nested loops can make this dimension take any value*/
+        if (a.varying || b.varying)
+          continue;
+
+        long long int delta = b.offset - a.offset;
+        if (a.coefficient == 0 && b.coefficient == 0) {
+          if (delta != 0)
+            return false;
+          continue;
+        }
+        if (a.coefficient == b.coefficient) {
+          if (delta % a.coefficient != 0)
+            return false;
+          long long int d = delta / a.coefficient;
+          if (fixed && d != fixedDistance)
+            return false;
+          fixed = true;
+          fixedDistance = d;
+          continue;
+        }
+        if (delta % gcd(a.coefficient, b.coefficient) != 0)
+          return false;
+        if (bounds.lowerConst && bounds.upperConst) {
+          long long int lo = std::min(bounds.lowerValue, bounds.upperValue);
+          long long int hi = std::max(bounds.lowerValue, bounds.upperValue);
+          long long int minA = std::min(a.coefficient * lo, a.coefficient * hi);
+          long long int maxA = std::max(a.coefficient * lo, a.coefficient * hi);
+          long long int minB = std::min(b.coefficient * lo, b.coefficient * hi);
+          long long int maxB = std::max(b.coefficient * lo, b.coefficient * hi);
+          if (delta < minA - maxB || delta > maxA - minB)
+            return false;
+        }
+        unknown = true;
+      }
+
+      if (fixed) {
+        /*the same iteration only*/
+        if (fixedDistance == 0)
+          return false;
+        if (bounds.lowerConst && bounds.upperConst &&
+            std::abs(fixedDistance) > std::abs(bounds.upperValue - bounds.lowerValue))
+          return false;
+        distance = to_string(std::abs(fixedDistance));
+      }
+      else if (!unknown)
+        distance = "any";
+      return true;
+    }
+
+    /*find arrays only accessed through associative updates with the same operator
+     * where some update doesn't move with the induction variable (a[k] += e, or a
+     * histogram h[idx[i]]++). They can be reduced as array sections*/
+    void findArrayReductions(vector<MemAccess> & accesses, VarDecl *var, set<VarDecl*> & written,
+                             DependenceInfo & info, set<ValueDecl*> & reducedArrays) {
+      set<ValueDecl*> checked;
+      for (int i = 0, ie = accesses.size(); i != ie; i++) {
+        ValueDecl *base = accesses[i].base;
+        if (!base || checked.count(base) != 0)
+          continue;
+        checked.insert(base);
+
+        bool reduction = true;
+        bool carried = false;
+        for (int j = i; j != ie && reduction; j++) {
+          if (accesses[j].base != base)
+            continue;
+          if (accesses[j].reductionOp.empty() || accesses[j].reductionOp != accesses[i].reductionOp)
+            reduction = false;
+          classifyAccess(accesses[j], var, written);
+          if (accesses[j].pattern != "unit stride" && accesses[j].pattern != "constant stride")
+            carried = true;
+        }
+        if (!reduction || !carried)
+          continue;
+
+        /*a single invariant element, or the whole array otherwise*/
+        std::string section = base->getNameAsString();
+        vector<pair<Expr*, long long int> > subscripts;
+        getSubscripts(accesses[i], subscripts);
+        if (accesses[i].pattern == "invariant" && subscripts.size() == 1 && subscripts[0].first->getType()->isPointerType())
+          section += "[0:1]";
+        else if (accesses[i].pattern == "invariant" && subscripts.size() == 1)
+          section += "[" + exprToString(subscripts[0].first) + ":1]";
+        else if (const ConstantArrayType *CAT = astContext->getAsConstantArrayType(base->getType()))
+          section += "[0:" + to_string(CAT->getSize().getZExtValue()) + "]";
+        /*a pointer can't be reduced as a whole, and elements picked through other
+         * arrays (h[idx[i]]) have no section known from the loop bounds. The updates
+         * are left to the dependence test*/
+        else if (base->getType()->isPointerType())
+          continue;
+        info.reductions.push_back(accesses[i].reductionOp + ":" + section);
+        info.reductionRefs.push_back(accesses[i].expr);
+        reducedArrays.insert(base);
+      }
+    }
+
+    /*check if a statement leaves the loop before its last iteration*/
+    bool isEarlyExit(Stmt *st, Stmt *loop) {
+      if (isa<ReturnStmt>(st) || isa<GotoStmt>(st))
+        return true;
+      if (!isa<BreakStmt>(st))
+        return false;
+      vector<Stmt*> enclosing;
+      getEnclosingStmts(st, enclosing);
+      for (int i = 0, ie = enclosing.size(); i != ie; i++) {
+        if (isa<DoStmt>(enclosing[i]) || isa<ForStmt>(enclosing[i]) ||
+            isa<WhileStmt>(enclosing[i]) || isa<SwitchStmt>(enclosing[i]))
+          return enclosing[i] == loop;
+      }
+      return false;
+    }
+
+    /*dependence analysis of a loop, shared by its own record and by the band checks
+     * of the loops enclosing it*/
+    DependenceInfo & getDependences(Stmt *st) {
+      if (dependenceCache.count(st) == 0)
+        analyzeDependences(st, dependenceCache[st]);
+      return dependenceCache[st];
+    }
+
+    /*dependence analysis of a loop: scalars are checked for def-use across iterations
+     * (reductions, privatizable or carried), array accesses with affine subscripts are
+     * tested pairwise, and calls or early exits block the parallelization*/
+    void analyzeDependences(Stmt *st, DependenceInfo & info) {
+      info.verdict = "dependent";
+      info.reductions.clear();
+      info.reductionRefs.clear();
+      info.privates.clear();
+      info.blocking.clear();
+      info.scalarKinds.clear();
+      info.scalarOrder.clear();
+      info.assumesNoAlias = false;
+
+      LoopBounds bounds;
+      if (!getLoopBounds(st, bounds)) {
+        info.blocking.push_back("non canonical loop");
+        return;
+      }
+      Stmt *body = getLoopBody(st);
+      VarDecl *var = bounds.inductionVar;
+
+      vector<Stmt*> nodes_list;
+      visitNodes(body, nodes_list);
+      for (int i = 0, ie = nodes_list.size(); i != ie; i++) {
+        if (CallExpr *CE = dyn_cast<CallExpr>(nodes_list[i])) {
+          FunctionDecl *FD = CE->getDirectCallee();
+          if (!FD)
+            info.blocking.push_back("indirect call " + exprToString(CE->getCallee()));
+          else if (!isKnownMathFunction(FD) && !FD->hasAttr<ConstAttr>() && !FD->hasAttr<PureAttr>())
+            info.blocking.push_back("call to " + FD->getNameAsString());
+        }
+        if (isEarlyExit(nodes_list[i], st))
+          info.blocking.push_back("early exit at line " + to_string(astContext->getFullLoc(nodes_list[i]->getBeginLoc()).getSpellingLineNumber()));
+      }
+
+      /*scalars declared outside the loop and written inside it*/
+      vector<ScalarAccess> scalars;
+      set<VarDecl*> seen;
+      collectScalarAccesses(body, true, false, false, scalars);
+      for (int i = 0, ie = scalars.size(); i != ie; i++) {
+        VarDecl *VD = scalars[i].var;
+        if (VD == var || seen.count(VD) != 0)
+          continue;
+        seen.insert(VD);
+        if (isDeclaredInside(VD, st))
+          continue;
+        info.scalarOrder.push_back(VD);
+
+        bool written = false;
+        bool reduction = true;
+        for (int j = i; j != ie; j++) {
+          if (scalars[j].var != VD)
+            continue;
+          written = written || scalars[j].isWrite;
+          if (scalars[j].reductionOp.empty() || scalars[j].reductionOp != scalars[i].reductionOp)
+            reduction = false;
+        }
+        if (!written) {
+          info.scalarKinds[VD] = "read only";
+          continue;
+        }
+        if (reduction) {
+          info.scalarKinds[VD] = "reduction";
+          info.reductions.push_back(scalars[i].reductionOp + ":" + VD->getNameAsString());
+          info.reductionRefs.push_back(scalars[i].ref);
+        }
+        else if (scalars[i].isWrite && !scalars[i].isRead && !scalars[i].conditional) {
+          info.scalarKinds[VD] = "private";
+          info.privates.push_back(VD->getNameAsString());
+        }
+        else {
+          info.scalarKinds[VD] = "carried";
+          info.blocking.push_back("scalar " + VD->getNameAsString() + " carried across iterations");
+        }
+      }
+
+      /*pairs of accesses to the same array where at least one of them writes*/
+      set<VarDecl*> written, innerInductionVars;
+      vector<MemAccess> accesses;
+      collectWrittenVars(body, written, innerInductionVars);
+      written.erase(var);
+      collectMemAccesses(body, true, false, accesses);
+      set<ValueDecl*> reducedArrays;
+      findArrayReductions(accesses, var, written, info, reducedArrays);
+      for (int i = 0, ie = accesses.size(); i != ie; i++) {
+        if (!accesses[i].isWrite || reducedArrays.count(accesses[i].base) != 0)
+          continue;
+        if (!accesses[i].base) {
+          info.blocking.push_back("write to " + exprToString(accesses[i].expr) + " through an unknown base");
+          continue;
+        }
+        for (int j = 0; j != ie; j++) {
+          if (j < i && accesses[j].isWrite)
+            continue;
+          if (accesses[j].base != accesses[i].base) {
+            if (accesses[i].base->getType()->isPointerType() && accesses[j].base &&
+                accesses[j].base->getType()->isPointerType() &&
+                !accesses[i].base->getType().isRestrictQualified())
+              info.assumesNoAlias = true;
+            continue;
+          }
+          std::string distance;
+          if (testDependence(accesses[i], accesses[j], var, written, innerInductionVars, bounds, distance))
+            info.blocking.push_back(exprToString(accesses[i].expr) + " -> " + exprToString(accesses[j].expr) + ": distance " + distance);
+        }
+      }
+
+      if (info.blocking.size() > 0)
+        info.verdict = "dependent";
+      else if (info.reductions.size() > 0)
+        info.verdict = "reduction parallel";
+      else
+        info.verdict = "parallel";
+    }
+
+    /*Json fields with the result of the dependence analysis*/
+    std::string getDependenceInfo(DependenceInfo & info) {
+      std::string fields = ",\n\"dependence verdict\":\"" + info.verdict + "\"";
+      if (info.reductions.size() > 0)
+        fields += ",\n\"reduction candidates\":[" + joinJsonList(info.reductions) + "]";
+      if (info.privates.size() > 0)
+        fields += ",\n\"private candidates\":[" + joinJsonList(info.privates) + "]";
+      if (info.blocking.size() > 0)
+        fields += ",\n\"blocking dependences\":[" + joinJsonList(info.blocking) + "]";
+      if (info.assumesNoAlias)
+        fields += ",\n\"assumes no aliasing\":\"true\"";
+      return fields;
+    }
+
+    /*synchronization directive protecting a statement inside a loop ("atomic",
+     * "critical" or "ordered"), or an empty string if there is none*/
+    std::string getEnclosingSync(Stmt *st, Stmt *loop) {
+      vector<Stmt*> enclosing;
+      getEnclosingStmts(st, enclosing);
+      for (int i = 0, ie = enclosing.size(); i != ie && enclosing[i] != loop; i++) {
+        if (isa<OMPAtomicDirective>(enclosing[i]))
+          return "atomic";
+        if (isa<OMPCriticalDirective>(enclosing[i]))
+          return "critical";
+        if (isa<OMPOrderedDirective>(enclosing[i]))
+          return "ordered";
+      }
+      return std::string();
+    }
+
+    /*check if a variable is listed in a clause recovered by ClassifyClause, as "x",
+     * "+:x" or "x[0:n]"*/
+    bool clauseHasVar(map<string, string> & clauses, std::string clause, std::string name) {
+      vector<std::string> vars = getClauseVars(clauses, clause);
+      return std::find(vars.begin(), vars.end(), name) != vars.end();
+    }
+
+    /*names of the variables listed in a clause recovered by ClassifyClause, without
+     * reduction operators or array sections*/
+    vector<std::string> getClauseVars(map<string, string> & clauses, std::string clause) {
+      vector<std::string> vars;
+      if (clauses.count(clause) == 0)
+        return vars;
+
+      SmallVector<StringRef, 8> items;
+      StringRef(clauses[clause]).split(items, ",", -1, false);
+      for (int i = 0, ie = items.size(); i != ie; i++) {
+        StringRef item = items[i].trim('"');
+        size_t bracket = item.find('[');
+        size_t colon = item.find(':');
+        if (colon != StringRef::npos && colon < bracket)
+          item = item.substr(colon + 1);
+        vars.push_back(item.substr(0, item.find('[')).str());
+      }
+      return vars;
+    }
+
+    /*check if the value a variable has at the end of a loop may be used afterwards.
+     * Globals, static locals and references escape the function, other locals are
+     * live when they are read after the loop before being overwritten*/
+    bool isLiveOut(VarDecl *VD, Stmt *loop) {
+      if (!VD->hasLocalStorage() || VD->getType()->isReferenceType())
+        return true;
+
+      vector<Stmt*> enclosing;
+      getEnclosingStmts(loop, enclosing);
+      if (enclosing.empty())
+        return false;
+
+      const SourceManager& mng = astContext->getSourceManager();
+      vector<ScalarAccess> accesses;
+      collectScalarAccesses(enclosing.back(), true, false, false, accesses);
+      for (int i = 0, ie = accesses.size(); i != ie; i++) {
+        if (accesses[i].var != VD || !mng.isBeforeInTranslationUnit(loop->getEndLoc(), accesses[i].ref->getBeginLoc()))
+          continue;
+        if (accesses[i].isRead)
+          return true;
+        if (accesses[i].isWrite && !accesses[i].conditional)
+          return false;
+      }
+      return false;
+    }
+
+    /*Json fields comparing the scalars a directive loop should privatize with the ones
+     * listed in its clauses: values written before being read in every iteration are
+     * private candidates (lastprivate when they are used after the loop)*/
+    std::string getPrivatizationInfo(Stmt *st, DependenceInfo & info, map<string, string> & clauseType) {
+      vector<std::string> privates, lastprivates, mismatches;
+      for (int i = 0, ie = info.scalarOrder.size(); i != ie; i++) {
+        VarDecl *VD = info.scalarOrder[i];
+        std::string name = VD->getNameAsString();
+        if (info.scalarKinds[VD] != "private" || isPrivateToRegion(VD, st))
+          continue;
+        bool liveOut = isLiveOut(VD, st);
+        if (liveOut && !clauseHasVar(clauseType, "lastprivate", name))
+          lastprivates.push_back(name);
+        else if (!liveOut && !clauseHasVar(clauseType, "private", name) && !clauseHasVar(clauseType, "firstprivate", name) &&
+                 !clauseHasVar(clauseType, "lastprivate", name) && !clauseHasVar(clauseType, "linear", name))
+          privates.push_back(name);
+      }
+
+      /*privatized variables whose use in the loop doesn't match the clause*/
+      vector<std::string> listed = getClauseVars(clauseType, "private");
+      vector<std::string> lastListed = getClauseVars(clauseType, "lastprivate");
+      for (int i = 0, ie = info.scalarOrder.size(); i != ie; i++) {
+        VarDecl *VD = info.scalarOrder[i];
+        std::string name = VD->getNameAsString();
+        if (std::find(listed.begin(), listed.end(), name) != listed.end()) {
+          if (info.scalarKinds[VD] == "carried" || info.scalarKinds[VD] == "read only")
+            mismatches.push_back(name + ": private but read before written, needs firstprivate");
+        }
+        if (std::find(lastListed.begin(), lastListed.end(), name) != lastListed.end()) {
+          if (!isLiveOut(VD, st))
+            mismatches.push_back(name + ": lastprivate but not used after the loop, private is enough");
+        }
+      }
+
+      std::string fields = std::string();
+      if (privates.size() > 0)
+        fields += ",\n\"private candidates\":[" + joinJsonList(privates) + "]";
+      if (lastprivates.size() > 0)
+        fields += ",\n\"lastprivate candidates\":[" + joinJsonList(lastprivates) + "]";
+      if (mismatches.size() > 0)
+        fields += ",\n\"privatization mismatches\":[" + joinJsonList(mismatches) + "]";
+      return fields;
+    }
+
+    /*check if a variable is private to the OpenMP regions enclosing a statement, because
+     * it is declared inside one of them*/
+    bool isPrivateToRegion(VarDecl *VD, Stmt *st) {
+      vector<Stmt*> enclosing;
+      getEnclosingStmts(st, enclosing);
+      for (int i = 0, ie = enclosing.size(); i != ie; i++)
+        if (isa<OMPExecutableDirective>(enclosing[i]) && isDeclaredInside(VD, enclosing[i]))
+          return true;
+      return false;
+    }
+
+    /*Json fields with the reductions a directive loop performs without a reduction
+     * clause, and how the updates are done instead*/
+    std::string getMissingReductionInfo(Stmt *st, DependenceInfo & info, map<string, string> & clauseType) {
+      vector<std::string> missing;
+      int syncUpdates = 0;
+      for (int i = 0, ie = info.reductions.size(); i != ie; i++) {
+        std::string name = info.reductions[i].substr(info.reductions[i].find(':') + 1);
+        name = name.substr(0, name.find('['));
+        if (clauseHasVar(clauseType, "reduction", name) || clauseHasVar(clauseType, "private", name) ||
+            clauseHasVar(clauseType, "firstprivate", name) || clauseHasVar(clauseType, "lastprivate", name))
+          continue;
+        VarDecl *VD = getReferencedVar(info.reductionRefs[i]);
+        if (VD && isPrivateToRegion(VD, st))
+          continue;
+
+        std::string sync = getEnclosingSync(info.reductionRefs[i], st);
+        if (!sync.empty())
+          syncUpdates++;
+        missing.push_back("reduction(" + info.reductions[i] + ") instead of " + (sync.empty() ? "unprotected updates" : sync));
+      }
+
+      if (missing.size() == 0)
+        return std::string();
+      std::string fields = ",\n\"missing reductions\":[" + joinJsonList(missing) + "]";
+      fields += ",\n\"reductions under atomic or critical\":\"" + to_string(syncUpdates) + "\"";
+      return fields;
+    }
+
+    /*check if a directive shares the iterations of its loop among threads (for,
+     * distribute and taskloop, alone or combined)*/
+    bool isWorksharingLoop(OMPExecutableDirective *OMPED) {
+      if (!OMPED)
+        return false;
+      OpenMPDirectiveKind kind = OMPED->getDirectiveKind();
+      return isOpenMPLoopDirective(kind) &&
+             (isOpenMPWorksharingDirective(kind) || isOpenMPDistributeDirective(kind) || isOpenMPTaskLoopDirective(kind));
+    }
+
+    /*check if a variable is privatized by a clause of the directive*/
+    bool isPrivatizedByClause(map<string, string> & clauseType, std::string name) {
+      return clauseHasVar(clauseType, "private", name) || clauseHasVar(clauseType, "firstprivate", name) ||
+             clauseHasVar(clauseType, "lastprivate", name) || clauseHasVar(clauseType, "linear", name) ||
+             clauseHasVar(clauseType, "reduction", name);
+    }
+
+    /*Json fields with the writes to shared memory of a worksharing loop that are not
+     * protected by atomic/critical/ordered or a reduction, and whose address doesn't
+     * depend on the induction variable: every thread writes the same location*/
+    std::string getSharedWriteInfo(Stmt *st, map<string, string> & clauseType) {
+      LoopBounds bounds;
+      if (!isWorksharingLoop(getLoopDirective(st)) || !getLoopBounds(st, bounds))
+        return std::string();
+      Stmt *body = getLoopBody(st);
+      VarDecl *var = bounds.inductionVar;
+      set<VarDecl*> none;
+      vector<std::string> races;
+
+      vector<ScalarAccess> scalars;
+      collectScalarAccesses(body, true, false, false, scalars);
+      for (int i = 0, ie = scalars.size(); i != ie; i++) {
+        VarDecl *VD = scalars[i].var;
+        std::string name = VD->getNameAsString();
+        if (!scalars[i].isWrite || VD == var || isDeclaredInside(VD, st) || isPrivateToRegion(VD, st) ||
+            isPrivatizedByClause(clauseType, name) || !getEnclosingSync(scalars[i].ref, st).empty())
+          continue;
+        unsigned int line = astContext->getFullLoc(scalars[i].ref->getBeginLoc()).getSpellingLineNumber();
+        races.push_back(name + " at line " + to_string(line) +
+                        (clauseHasVar(clauseType, "shared", name) ? " (explicitly shared)" : " (shared by default)"));
+      }
+
+      vector<MemAccess> accesses;
+      collectMemAccesses(body, true, false, accesses);
+      for (int i = 0, ie = accesses.size(); i != ie; i++) {
+        ValueDecl *base = accesses[i].base;
+        VarDecl *baseVar = dyn_cast_or_null<VarDecl>(base);
+        if (!accesses[i].isWrite || !getEnclosingSync(accesses[i].expr, st).empty())
+          continue;
+        if (baseVar && (isDeclaredInside(baseVar, st) || isPrivateToRegion(baseVar, st) ||
+                        isPrivatizedByClause(clauseType, baseVar->getNameAsString())))
+          continue;
+
+        bool dependent = false;
+        vector<pair<Expr*, long long int> > subscripts;
+        getSubscripts(accesses[i], subscripts);
+        for (int k = 0, ke = subscripts.size(); k != ke; k++)
+          dependent = dependent || dependsOnVars(subscripts[k].first, var, none);
+        if (dependent)
+          continue;
+        unsigned int line = astContext->getFullLoc(accesses[i].expr->getBeginLoc()).getSpellingLineNumber();
+        races.push_back(exprToString(accesses[i].expr) + " at line " + to_string(line));
+      }
+
+      std::string fields = ",\n\"unprotected shared writes\":\"" + to_string(races.size()) + "\"";
+      if (races.size() > 0)
+        fields += ",\n\"shared write list\":[" + joinJsonList(races) + "]";
+      return fields;
+    }
+
+    /*check if a statement calls omp_get_thread_num()*/
+    bool callsThreadNum(Stmt *st) {
+      vector<Stmt*> nodes_list;
+      visitNodes(st, nodes_list);
+      for (int i = 0, ie = nodes_list.size(); i != ie; i++) {
+        if (CallExpr *CE = dyn_cast<CallExpr>(nodes_list[i]))
+          if (CE->getDirectCallee() && CE->getDirectCallee()->getNameAsString() == "omp_get_thread_num")
+            return true;
+      }
+      return false;
+    }
+
+    /*collect the variables of the function holding the thread number, initialized or
+     * assigned from omp_get_thread_num()*/
+    void collectThreadIdVars(Stmt *st, set<VarDecl*> & tids) {
+      vector<Stmt*> enclosing;
+      getEnclosingStmts(st, enclosing);
+      vector<Stmt*> nodes_list;
+      visitNodes(enclosing.empty() ? st : enclosing.back(), nodes_list);
+      for (int i = 0, ie = nodes_list.size(); i != ie; i++) {
+        if (DeclStmt *DCst = dyn_cast<DeclStmt>(nodes_list[i])) {
+          for (auto I = DCst->decl_begin(), IE = DCst->decl_end(); I != IE; I++)
+            if (VarDecl *VD = dyn_cast<VarDecl>(*I))
+              if (VD->getInit() && callsThreadNum(VD->getInit()))
+                tids.insert(VD);
+        }
+        if (BinaryOperator *biop = dyn_cast<BinaryOperator>(nodes_list[i]))
+          if (biop->getOpcode() == BO_Assign && getReferencedVar(biop->getLHS()) && callsThreadNum(biop->getRHS()))
+            tids.insert(getReferencedVar(biop->getLHS()));
+      }
+    }
+
+    /*check if a statement is inside a loop directive nested in the given region*/
+    bool isInsideNestedLoopDirective(Stmt *st, Stmt *region) {
+      vector<Stmt*> enclosing;
+      getEnclosingStmts(st, enclosing);
+      for (int i = 0, ie = enclosing.size(); i != ie && enclosing[i] != region; i++)
+        if (isa<OMPLoopDirective>(enclosing[i]))
+          return true;
+      return false;
+    }
+
+    /*Json fields with the writes that different threads likely perform on the same cache
+     * line: elements of per-thread arrays indexed by the thread number, and chunks of a
+     * schedule smaller than a cache line. Works for loops and for parallel regions*/
+    std::string getFalseSharingInfo(Stmt *st, map<string, string> & clauseType) {
+      Stmt *body = nullptr;
+      LoopBounds bounds;
+      VarDecl *var = nullptr;
+      bool canonical = false;
+      if (OMPExecutableDirective *OMPED = dyn_cast<OMPExecutableDirective>(st))
+        body = OMPED->getInnermostCapturedStmt()->getCapturedStmt();
+      else {
+        body = getLoopBody(st);
+        canonical = getLoopBounds(st, bounds);
+        var = canonical ? bounds.inductionVar : nullptr;
+      }
+
+      set<VarDecl*> none, tids, written, innerInductionVars;
+      collectThreadIdVars(st, tids);
+      collectWrittenVars(body, written, innerInductionVars);
+      written.erase(var);
+
+      long long int chunk = 0;
+      bool hasChunk = (clauseType.count("schedule chunk") > 0) &&
+                      !StringRef(clauseType["schedule chunk"]).getAsInteger(10, chunk) && chunk > 0;
+      long long int line = machine.cacheLine;
+      long long int threads = machine.threads;
+
+      vector<std::string> risks;
+      vector<MemAccess> accesses;
+      collectMemAccesses(body, true, false, accesses);
+      for (int i = 0, ie = accesses.size(); i != ie; i++) {
+        VarDecl *baseVar = dyn_cast_or_null<VarDecl>(accesses[i].base);
+        if (!accesses[i].isWrite || accesses[i].bytes == 0)
+          continue;
+        if (baseVar && (isDeclaredInside(baseVar, st) || isPrivatizedByClause(clauseType, baseVar->getNameAsString())))
+          continue;
+        if (isa<OMPExecutableDirective>(st) && isInsideNestedLoopDirective(accesses[i].expr, st))
+          continue;
+        unsigned int lineNumber = astContext->getFullLoc(accesses[i].expr->getBeginLoc()).getSpellingLineNumber();
+        std::string where = exprToString(accesses[i].expr) + " at line " + to_string(lineNumber);
+
+        /*per-thread elements: threads write "spacing" bytes apart*/
+        bool threadIndexed = false;
+        vector<pair<Expr*, long long int> > subscripts;
+        getSubscripts(accesses[i], subscripts);
+        for (int k = 0, ke = subscripts.size(); k != ke && !threadIndexed; k++) {
+          if (!callsThreadNum(subscripts[k].first) && !dependsOnVars(subscripts[k].first, nullptr, tids))
+            continue;
+          threadIndexed = true;
+          long long int coefficient = 1;
+          bool symbolic = false;
+          for (set<VarDecl*>::iterator I = tids.begin(), IE = tids.end(); I != IE; I++) {
+            if (dependsOnVars(subscripts[k].first, *I, none)) {
+              if (!getAffineCoefficient(subscripts[k].first, *I, none, coefficient, symbolic))
+                coefficient = 1;
+              break;
+            }
+          }
+          long long int spacing = std::abs(coefficient * subscripts[k].second) * accesses[i].bytes;
+          if (symbolic || spacing == 0 || spacing >= line)
+            continue;
+          long long int threadsPerLine = std::min(threads, line / spacing);
+          long long int lines = (threads * spacing + line - 1) / line;
+          risks.push_back(where + ": threads write " + to_string(spacing) + " bytes apart, " + to_string(threadsPerLine) +
+                          " threads per cache line, " + to_string(lines) + " cache lines shared");
+        }
+        if (threadIndexed || !hasChunk || !var)
+          continue;
+
+        /*chunks of consecutive iterations smaller than a cache line*/
+        classifyAccess(accesses[i], var, written);
+        if (accesses[i].pattern != "unit stride" && accesses[i].pattern != "constant stride")
+          continue;
+        long long int chunkBytes = chunk * std::abs(accesses[i].stride) * accesses[i].bytes;
+        if (chunkBytes == 0 || chunkBytes >= line)
+          continue;
+        long long int threadsPerLine = std::min(threads, line / chunkBytes);
+        std::string lines = "all written";
+        if (bounds.tripConst)
+          lines = to_string((bounds.tripValue * std::abs(accesses[i].stride) * accesses[i].bytes + line - 1) / line);
+        risks.push_back(where + ": chunks of " + to_string(chunk) + " iterations write " + to_string(chunkBytes) + " bytes, " +
+                        to_string(threadsPerLine) + " threads per cache line, " + lines + " cache lines shared");
+      }
+
+      std::string fields = ",\n\"false sharing risks\":\"" + to_string(risks.size()) + "\"";
+      if (risks.size() > 0)
+        fields += ",\n\"false sharing list\":[" + joinJsonList(risks) + "]";
+      return fields;
+    }
+
+    /*amount of work of a statement, in operations: floating point operations plus
+     * memory accesses*/
+    unsigned int estimateWork(Stmt *st) {
+      LoopCost cost;
+      estimateLoopCost(st, cost);
+      vector<MemAccess> accesses;
+      collectMemAccesses(st, true, false, accesses);
+      return cost.flops + accesses.size();
+    }
+
+    /*ratio between the work of the most loaded thread and the mean work of the threads
+     * for a static schedule, where iteration k does "first + slope * k" work. A chunk of
+     * 0 stands for the default static schedule (one block of iterations per thread)*/
+    double simulateStaticImbalance(long long int trip, double first, double slope, long long int chunk) {
+      const long long int maxTrip = 1 << 20;
+      if (trip > maxTrip) {
+        slope = slope * trip / maxTrip;
+        chunk = (chunk > 0) ? std::max(1LL, chunk * maxTrip / trip) : 0;
+        trip = maxTrip;
+      }
+      long long int threads = std::min((long long int) machine.threads, trip);
+      if (threads <= 1)
+        return 1.0;
+      if (chunk <= 0)
+        chunk = (trip + threads - 1) / threads;
+
+      vector<double> work(threads, 0.0);
+      double total = 0.0;
+      for (long long int k = 0; k < trip; k++) {
+        double iterationWork = std::max(0.0, first + slope * k);
+        work[(k / chunk) % threads] += iterationWork;
+        total += iterationWork;
+      }
+      if (total == 0.0)
+        return 1.0;
+      return *std::max_element(work.begin(), work.end()) / (total / threads);
+    }
+
+    /*Json fields predicting the load imbalance of a worksharing loop: triangular nests
+     * (inner bounds depending on the induction variable) and irregular bodies (data
+     * dependent loops, early exits, conditionals guarding most of the work). The imbalance
+     * of static schedules is simulated, and a dynamic or guided schedule is recommended
+     * when the current one is likely poor*/
+    std::string getLoadBalanceInfo(Stmt *st, map<string, string> & clauseType) {
+      LoopBounds bounds;
+      OMPExecutableDirective *OMPED = getLoopDirective(st);
+      if (!OMPED || !isOpenMPLoopDirective(OMPED->getDirectiveKind()) ||
+          !isOpenMPWorksharingDirective(OMPED->getDirectiveKind()) || !getLoopBounds(st, bounds))
+        return std::string();
+      Stmt *body = getLoopBody(st);
+      VarDecl *var = bounds.inductionVar;
+      set<VarDecl*> none, written, innerInductionVars;
+      collectWrittenVars(body, written, innerInductionVars);
+      written.erase(var);
+
+      bool triangular = false, irregular = false, exactWork = false;
+      double first = 0.0, slope = 1.0;
+      unsigned int bodyWork = estimateWork(body);
+      vector<std::string> sources;
+
+      vector<Stmt*> nodes_list;
+      visitNodes(body, nodes_list);
+      for (int i = 0, ie = nodes_list.size(); i != ie; i++) {
+        Stmt *node = nodes_list[i];
+        std::string where = " at line " + to_string(astContext->getFullLoc(node->getBeginLoc()).getSpellingLineNumber());
+        if (isa<WhileStmt>(node) || isa<DoStmt>(node)) {
+          irregular = true;
+          sources.push_back("data dependent loop" + where);
+        }
+        else if (ForStmt *fstmt = dyn_cast<ForStmt>(node)) {
+          LoopBounds inner;
+          if (!getLoopBounds(fstmt, inner)) {
+            irregular = true;
+            sources.push_back("non canonical loop" + where);
+          }
+          else if (hasDependentLoad(inner.lowerExpr, var, written) || hasDependentLoad(inner.upperExpr, var, written) ||
+                   dependsOnVars(inner.lowerExpr, nullptr, written) || dependsOnVars(inner.upperExpr, nullptr, written)) {
+            irregular = true;
+            sources.push_back("inner bounds computed from data" + where);
+          }
+          else if (dependsOnVars(inner.lowerExpr, var, none) || dependsOnVars(inner.upperExpr, var, none)) {
+            triangular = true;
+            sources.push_back("inner bounds depend on " + var->getNameAsString() + where);
+            /*work of the outer iterations, from the affine form of the inner bounds*/
+            AffineSubscript lower, upper;
+            if (!exactWork && bounds.lowerConst && inner.stepConst &&
+                getAffineSubscript(inner.lowerExpr, var, written, innerInductionVars, lower) &&
+                getAffineSubscript(inner.upperExpr, var, written, innerInductionVars, upper) &&
+                lower.symbolic.empty() && upper.symbolic.empty() && !lower.varying && !upper.varying) {
+              long long int coefficient = upper.coefficient - lower.coefficient;
+              first = (double) (upper.offset - lower.offset + coefficient * bounds.lowerValue) / inner.stepValue;
+              slope = (double) coefficient * bounds.stepValue / inner.stepValue;
+              exactWork = true;
+            }
+          }
+        }
+        else if (isa<BreakStmt>(node)) {
+          vector<Stmt*> enclosing;
+          getEnclosingStmts(node, enclosing);
+          for (int k = 0, ke = enclosing.size(); k != ke; k++) {
+            if (isa<DoStmt>(enclosing[k]) || isa<ForStmt>(enclosing[k]) ||
+                isa<WhileStmt>(enclosing[k]) || isa<SwitchStmt>(enclosing[k])) {
+              if (!isa<SwitchStmt>(enclosing[k]) && enclosing[k] != st) {
+                irregular = true;
+                sources.push_back("early exit" + where);
+              }
+              break;
+            }
+          }
+        }
+        else if (IfStmt *ifst = dyn_cast<IfStmt>(node)) {
+          unsigned int thenWork = estimateWork(ifst->getThen());
+          unsigned int elseWork = ifst->getElse() ? estimateWork(ifst->getElse()) : 0;
+          if (dependsOnVars(ifst->getCond(), var, written) && 2 * thenWork >= bodyWork && thenWork > 2 * elseWork) {
+            irregular = true;
+            sources.push_back("conditional guarding most of the work" + where);
+          }
+        }
+      }
+
+      if (sources.empty())
+        return ",\n\"load imbalance\":\"none\"";
+
+      std::string info = std::string();
+      info += ",\n\"load imbalance\":\"" + std::string(triangular ? (irregular ? "triangular and irregular" : "triangular") : "irregular") + "\"";
+      info += ",\n\"imbalance sources\":[" + joinJsonList(sources) + "]";
+
+      /*only static schedules are simulated, the others balance the work at run time*/
+      std::string schedule = (clauseType.count("schedule") > 0) ? clauseType["schedule"] : "static";
+      long long int chunk = 0;
+      bool chunkKnown = (clauseType.count("schedule chunk") == 0) ||
+                        !StringRef(clauseType["schedule chunk"]).getAsInteger(10, chunk);
+      double imbalance = 0.0;
+      if (schedule == "static" && triangular && !irregular && chunkKnown) {
+        /*unknown trip counts or bounds are estimated as a pure triangle*/
+        long long int trip = bounds.tripConst ? bounds.tripValue : 64 * (long long int) machine.threads;
+        if (!exactWork || !bounds.tripConst) {
+          first = 1.0;
+          slope = 1.0;
+        }
+        imbalance = simulateStaticImbalance(trip, first, slope, chunk);
+        info += ",\n\"estimated imbalance\":\"" + doubleToString(imbalance) + "\"";
+      }
+      else
+        info += ",\n\"estimated imbalance\":\"unknown\"";
+
+      if (schedule == "static" && (irregular || imbalance > 1.1)) {
+        std::string recommended = irregular ? "dynamic" : "guided";
+        if (bounds.tripConst)
+          recommended += ", " + to_string(std::max(1LL, bounds.tripValue / (8 * (long long int) std::max(1u, machine.threads))));
+        info += ",\n\"recommended schedule\":\"schedule(" + recommended + ")\"";
+      }
+      return info;
+    }
+
+    /*work of all the iterations of a loop, with nested loops multiplied by their trip
+     * counts. Returns false when some trip count is unknown or the loop calls functions
+     * that can't be costed*/
+    bool estimateTotalWork(Stmt *loop, double & work) {
+      LoopBounds bounds;
+      if (!getLoopBounds(loop, bounds) || !bounds.tripConst)
+        return false;
+      Stmt *body = getLoopBody(loop);
+      double iterationWork = estimateWork(body);
+
+      vector<Stmt*> nodes_list;
+      visitNodes(body, nodes_list);
+      for (int i = 0, ie = nodes_list.size(); i != ie; i++) {
+        if (CallExpr *CE = dyn_cast<CallExpr>(nodes_list[i]))
+          if (!CE->getDirectCallee() || !isKnownMathFunction(CE->getDirectCallee()))
+            return false;
+        if (!isa<DoStmt>(nodes_list[i]) && !isa<ForStmt>(nodes_list[i]) && !isa<WhileStmt>(nodes_list[i]))
+          continue;
+        /*only the loops directly nested, the deeper ones are costed by them*/
+        vector<Stmt*> enclosing;
+        getEnclosingStmts(nodes_list[i], enclosing);
+        for (int k = 0, ke = enclosing.size(); k != ke; k++) {
+          if (isa<DoStmt>(enclosing[k]) || isa<ForStmt>(enclosing[k]) || isa<WhileStmt>(enclosing[k])) {
+            if (enclosing[k] == loop) {
+              double innerWork;
+              if (!estimateTotalWork(nodes_list[i], innerWork))
+                return false;
+              iterationWork += innerWork - estimateWork(getLoopBody(nodes_list[i]));
+            }
+            break;
+          }
+        }
+      }
+      work = bounds.tripValue * iterationWork;
+      return true;
+    }
+
+    /*check if a directive creates a team of threads, tasks or a device kernel, paying
+     * the fork/join or launch overhead each time it is reached*/
+    bool isForkingDirective(Stmt *st) {
+      OMPExecutableDirective *OMPED = dyn_cast<OMPExecutableDirective>(st);
+      if (!OMPED)
+        return false;
+      if (isa<OMPParallelDirective>(OMPED) || isTargetDirective(OMPED) ||
+          isa<OMPTaskLoopDirective>(OMPED) || isa<OMPTaskLoopSimdDirective>(OMPED))
+        return true;
+      return classifyPragma(OMPED, false).find("parallel") != std::string::npos;
+    }
+
+    /*the innermost directive that forks the threads running a statement, if any*/
+    OMPExecutableDirective *getForkingDirective(Stmt *st) {
+      if (isForkingDirective(st))
+        return cast<OMPExecutableDirective>(st);
+      vector<Stmt*> enclosing;
+      getEnclosingStmts(st, enclosing);
+      for (int i = 0, ie = enclosing.size(); i != ie; i++)
+        if (isForkingDirective(enclosing[i]))
+          return cast<OMPExecutableDirective>(enclosing[i]);
+      return nullptr;
+    }
+
+    /*the directive a loop is associated to (the innermost one around it)*/
+    OMPExecutableDirective *getLoopDirective(Stmt *st) {
+      vector<Stmt*> enclosing;
+      getEnclosingStmts(st, enclosing);
+      for (int i = 0, ie = enclosing.size(); i != ie; i++)
+        if (OMPExecutableDirective *OMPED = dyn_cast<OMPExecutableDirective>(enclosing[i]))
+          return OMPED;
+      return nullptr;
+    }
+
+    /*sequential loops of the function around a construct, innermost first. Loops that
+     * are inside other directives are left out, as they don't run on the initial thread*/
+    void getSequentialLoopsAround(Stmt *st, vector<Stmt*> & loops) {
+      vector<Stmt*> enclosing;
+      getEnclosingStmts(st, enclosing);
+      for (int i = 0, ie = enclosing.size(); i != ie; i++) {
+        if (isa<OMPExecutableDirective>(enclosing[i]))
+          return;
+        if (isa<DoStmt>(enclosing[i]) || isa<ForStmt>(enclosing[i]) || isa<WhileStmt>(enclosing[i]))
+          loops.push_back(enclosing[i]);
+      }
+    }
+
+    /*Json fields with the overhead of a parallel, taskloop or target loop: its work per
+     * invocation is compared to the thresholds of the machine description, and the
+     * sequential loops around it tell how many times the overhead is paid*/
+    std::string getOverheadInfo(Stmt *st) {
+      OMPExecutableDirective *construct = getForkingDirective(st);
+      if (!construct)
+        return std::string();
+      bool offload = isTargetDirective(construct);
+      vector<std::string> warnings;
+      std::string info = std::string();
+
+      /*the loop is all the work of the construct only for combined directives*/
+      double work = 0.0;
+      bool workKnown = (getLoopDirective(st) == construct) && estimateTotalWork(st, work);
+      info += ",\n\"work per invocation\":\"" + (workKnown ? to_string((long long int) work) : std::string("unknown")) + "\"";
+      double threshold = offload ? machine.minOffloadWork : machine.minParallelWork;
+      if (workKnown && work < threshold)
+        warnings.push_back("work per invocation of " + to_string((long long int) work) + " operations is below the " +
+                           (offload ? "offload" : "parallel") + " threshold of " + to_string((long long int) threshold));
+
+      /*number of times the construct is reached*/
+      vector<Stmt*> loops;
+      getSequentialLoopsAround(construct, loops);
+      long long int invocations = 1;
+      bool invocationsKnown = true;
+      for (int i = 0, ie = loops.size(); i != ie; i++) {
+        LoopBounds bounds;
+        if (getLoopBounds(loops[i], bounds) && bounds.tripConst)
+          invocations *= bounds.tripValue;
+        else
+          invocationsKnown = false;
+      }
+      info += ",\n\"invocations\":\"" + (invocationsKnown ? to_string(invocations) : std::string("unknown")) + "\"";
+
+      /*loops reached at least this many times are considered hot*/
+      const long long int hotInvocations = 100;
+      if (!loops.empty() && (!invocationsKnown || invocations >= hotInvocations)) {
+        unsigned int line = astContext->getFullLoc(loops[0]->getBeginLoc()).getSpellingLineNumber();
+        warnings.push_back(std::string(offload ? "target" : "parallel") + " construct inside the sequential loop at line " +
+                           to_string(line) + ", reached " + (invocationsKnown ? to_string(invocations) : std::string("an unknown number of")) + " times");
+      }
+      if (warnings.size() > 0)
+        info += ",\n\"overhead warnings\":[" + joinJsonList(warnings) + "]";
+      return info;
+    }
+
+    /*Json fields for a parallel construct inside a sequential loop of its function, which
+     * forks a team on every iteration: the enclosing loop, its trip count and whether the
+     * region can be hoisted around the loop (turning the construct into a worksharing one)*/
+    std::string getHoistingInfo(OMPExecutableDirective *construct) {
+      vector<Stmt*> loops;
+      getSequentialLoopsAround(construct, loops);
+      if (loops.empty())
+        return std::string();
+      Stmt *loop = loops[0];
+      Stmt *body = getLoopBody(loop);
+      LoopBounds bounds;
+      std::string tripCount = getLoopBounds(loop, bounds) ? bounds.tripCount : "unknown";
+      vector<std::string> notes;
+      std::string hoistable = "yes";
+
+      std::string info = std::string();
+      info += ",\n\"enclosing sequential loop\":\"" + to_string(astContext->getFullLoc(loop->getBeginLoc()).getSpellingLineNumber()) + "\"";
+      info += ",\n\"enclosing loop trip count\":\"" + tripCount + "\"";
+
+      if (isTargetDirective(construct)) {
+        hoistable = "no";
+        notes.push_back("target construct, keep the data on the device around the loop instead");
+      }
+
+      /*statements of the loop that would run inside the hoisted region*/
+      vector<Stmt*> nodes_list;
+      visitNodes(body, nodes_list);
+      for (int i = 0, ie = nodes_list.size(); i != ie; i++) {
+        if (isEarlyExit(nodes_list[i], loop)) {
+          hoistable = "no";
+          notes.push_back("early exit at line " + to_string(astContext->getFullLoc(nodes_list[i]->getBeginLoc()).getSpellingLineNumber()));
+        }
+      }
+      if (hoistable == "yes") {
+        unsigned int constructs = 0;
+        vector<Stmt*> children;
+        if (CompoundStmt *CS = dyn_cast<CompoundStmt>(body))
+          children.insert(children.end(), CS->body_begin(), CS->body_end());
+        else
+          children.push_back(body);
+        for (int i = 0, ie = children.size(); i != ie; i++) {
+          if (isForkingDirective(children[i])) {
+            constructs++;
+            continue;
+          }
+          if (isa<NullStmt>(children[i]) || isa<DeclStmt>(children[i]))
+            continue;
+          hoistable = "with single";
+          notes.push_back("statement at line " + to_string(astContext->getFullLoc(children[i]->getBeginLoc()).getSpellingLineNumber()) +
+                          " must run in a single construct");
+        }
+        if (constructs > 1)
+          notes.push_back(to_string(constructs) + " parallel constructs of the loop would share the same region");
+      }
+
+      /*the loop test runs on every thread after hoisting*/
+      Expr *cond = nullptr;
+      if (ForStmt *fstmt = dyn_cast<ForStmt>(loop))
+        cond = fstmt->getCond();
+      if (WhileStmt *whst = dyn_cast<WhileStmt>(loop))
+        cond = whst->getCond();
+      if (DoStmt *dost = dyn_cast<DoStmt>(loop))
+        cond = dost->getCond();
+      set<VarDecl*> written, innerInductionVars;
+      collectWrittenVars(construct->getInnermostCapturedStmt()->getCapturedStmt(), written, innerInductionVars);
+      if (hoistable != "no" && cond && dependsOnVars(cond, nullptr, written))
+        notes.push_back("the loop condition reads data written in the region, a barrier is needed before the test");
+
+      info += ",\n\"hoistable\":\"" + hoistable + "\"";
+      if (notes.size() > 0)
+        info += ",\n\"hoisting notes\":[" + joinJsonList(notes) + "]";
+      return info;
+    }
+
+    /*check if a directive is a worksharing construct, ended by an implicit barrier*/
+    bool isWorksharingConstruct(Stmt *st) {
+      return isa<OMPForDirective>(st) || isa<OMPForSimdDirective>(st) ||
+             isa<OMPSingleDirective>(st) || isa<OMPSectionsDirective>(st);
+    }
+
+    /*check if a directive has a nowait clause*/
+    bool hasNowait(OMPExecutableDirective *OMPED) {
+      for (int i = 0, ie = OMPED->getNumClauses(); i != ie; i++)
+        if (isa<OMPNowaitClause>(OMPED->getClause(i)))
+          return true;
+      return false;
+    }
+
+    /*collect the variables and arrays read and written by a worksharing construct, without
+     * the ones declared inside it or privatized by its clauses. Returns false when the
+     * construct calls functions, whose accesses are unknown*/
+    bool collectAccessedDecls(OMPExecutableDirective *OMPED, set<ValueDecl*> & reads, set<ValueDecl*> & writes) {
+      Stmt *body = OMPED->getInnermostCapturedStmt()->getCapturedStmt();
+      map<string, string> clauses;
+      for (int i = 0, ie = OMPED->getNumClauses(); i != ie; i++)
+        ClassifyClause(OMPED->getClause(i), clauses);
+      LoopBounds bounds;
+      VarDecl *inductionVar = getLoopBounds(body, bounds) ? bounds.inductionVar : nullptr;
+
+      vector<Stmt*> nodes_list;
+      visitNodes(body, nodes_list);
+      for (int i = 0, ie = nodes_list.size(); i != ie; i++)
+        if (CallExpr *CE = dyn_cast<CallExpr>(nodes_list[i]))
+          if (!CE->getDirectCallee() || !isKnownMathFunction(CE->getDirectCallee()))
+            return false;
+
+      vector<MemAccess> accesses;
+      collectMemAccesses(body, true, false, accesses);
+      for (int i = 0, ie = accesses.size(); i != ie; i++) {
+        if (!accesses[i].base)
+          return false;
+        if (accesses[i].isRead)
+          reads.insert(accesses[i].base);
+        if (accesses[i].isWrite)
+          writes.insert(accesses[i].base);
+      }
+      vector<ScalarAccess> scalars;
+      collectScalarAccesses(body, true, false, false, scalars);
+      for (int i = 0, ie = scalars.size(); i != ie; i++) {
+        VarDecl *VD = scalars[i].var;
+        if (VD == inductionVar || isDeclaredInside(VD, OMPED) || clauseHasVar(clauses, "private", VD->getNameAsString()))
+          continue;
+        if (scalars[i].isRead)
+          reads.insert(VD);
+        if (scalars[i].isWrite)
+          writes.insert(VD);
+      }
+      return true;
+    }
+
+    /*check if two worksharing constructs may touch the same data, with at least one of them
+     * writing it. Different pointers are assumed to alias*/
+    bool mayConflict(OMPExecutableDirective *first, OMPExecutableDirective *second) {
+      set<ValueDecl*> firstReads, firstWrites, secondReads, secondWrites;
+      if (!collectAccessedDecls(first, firstReads, firstWrites) || !collectAccessedDecls(second, secondReads, secondWrites))
+        return true;
+      for (int pass = 0; pass != 2; pass++) {
+        set<ValueDecl*> & writes = pass ? secondWrites : firstWrites;
+        set<ValueDecl*> & reads = pass ? firstReads : secondReads;
+        set<ValueDecl*> & others = pass ? firstWrites : secondWrites;
+        for (set<ValueDecl*>::iterator I = writes.begin(), IE = writes.end(); I != IE; I++) {
+          for (int k = 0; k != 2; k++) {
+            set<ValueDecl*> & accessed = k ? others : reads;
+            for (set<ValueDecl*>::iterator J = accessed.begin(), JE = accessed.end(); J != JE; J++)
+              if (*I == *J || ((*I)->getType()->isPointerType() && (*J)->getType()->isPointerType()))
+                return true;
+          }
+        }
+      }
+      return false;
+    }
+
+    /*number of times a statement runs in each execution of a region, from the trip counts
+     * of the loops between them. Returns -1 when some trip count is unknown*/
+    long long int getExecutionsInRegion(Stmt *st, Stmt *region) {
+      vector<Stmt*> enclosing;
+      getEnclosingStmts(st, enclosing);
+      long long int executions = 1;
+      for (int i = 0, ie = enclosing.size(); i != ie && enclosing[i] != region; i++) {
+        if (!isa<DoStmt>(enclosing[i]) && !isa<ForStmt>(enclosing[i]) && !isa<WhileStmt>(enclosing[i]))
+          continue;
+        LoopBounds bounds;
+        if (!getLoopBounds(enclosing[i], bounds) || !bounds.tripConst)
+          return -1;
+        executions *= bounds.tripValue;
+      }
+      return executions;
+    }
+
+    /*Json fields with the barriers of a parallel region: implicit barriers of worksharing
+     * constructs without nowait, explicit barriers and the one at the end of the region.
+     * Adjacent worksharing constructs that don't share written data, and the ones whose
+     * barrier is followed by another barrier, are nowait opportunities*/
+    std::string getBarrierInfo(OMPExecutableDirective *region) {
+      unsigned int worksharing = 0, implicitBarriers = 0, explicitBarriers = 0;
+      long long int executed = 1;
+      vector<std::string> opportunities;
+
+      vector<Stmt*> nodes_list;
+      visitNodes(region->getInnermostCapturedStmt()->getCapturedStmt(), nodes_list);
+      for (int i = 0, ie = nodes_list.size(); i != ie; i++) {
+        Stmt *node = nodes_list[i];
+        if (!isa<OMPExecutableDirective>(node) || getForkingDirective(node) != region)
+          continue;
+        bool barrier = false;
+        if (isWorksharingConstruct(node)) {
+          worksharing++;
+          barrier = !hasNowait(cast<OMPExecutableDirective>(node));
+          if (barrier)
+            implicitBarriers++;
+        }
+        if (isa<OMPBarrierDirective>(node)) {
+          explicitBarriers++;
+          barrier = true;
+        }
+        long long int executions = getExecutionsInRegion(node, region);
+        if (barrier)
+          executed = (executed < 0 || executions < 0) ? -1 : executed + executions;
+
+        /*the statement run after a worksharing construct with a barrier*/
+        CompoundStmt *CS = nullptr;
+        vector<Stmt*> enclosing;
+        getEnclosingStmts(node, enclosing);
+        if (!enclosing.empty())
+          CS = dyn_cast<CompoundStmt>(enclosing[0]);
+        if (!isWorksharingConstruct(node) || !barrier || !CS)
+          continue;
+        Stmt *next = nullptr;
+        bool found = false;
+        for (auto I = CS->body_begin(), IE = CS->body_end(); I != IE && !next; I++) {
+          if (found && !isa<NullStmt>(*I))
+            next = *I;
+          if (*I == node)
+            found = true;
+        }
+        unsigned int line = astContext->getFullLoc(node->getBeginLoc()).getSpellingLineNumber();
+        std::string where = classifyPragma(cast<OMPExecutableDirective>(node), false);
+        if (where.empty())
+          where = isa<OMPSingleDirective>(node) ? "single" : "sections";
+        where += " at line " + to_string(line);
+        if (!next && CS == region->getInnermostCapturedStmt()->getCapturedStmt())
+          opportunities.push_back(where + ": followed by the barrier at the end of the region");
+        else if (next && isa<OMPBarrierDirective>(next))
+          opportunities.push_back(where + ": followed by an explicit barrier");
+        else if (next && isWorksharingConstruct(next) &&
+                 !mayConflict(cast<OMPExecutableDirective>(node), cast<OMPExecutableDirective>(next)))
+          opportunities.push_back(where + ": independent of the next construct, at line " +
+                                  to_string(astContext->getFullLoc(next->getBeginLoc()).getSpellingLineNumber()));
+      }
+
+      std::string info = std::string();
+      info += ",\n\"worksharing constructs\":\"" + to_string(worksharing) + "\"";
+      info += ",\n\"implicit barriers\":\"" + to_string(implicitBarriers) + "\"";
+      info += ",\n\"explicit barriers\":\"" + to_string(explicitBarriers) + "\"";
+      info += ",\n\"barriers per execution\":\"" + ((executed < 0) ? std::string("unknown") : to_string(executed)) + "\"";
+      if (opportunities.size() > 0)
+        info += ",\n\"nowait opportunities\":[" + joinJsonList(opportunities) + "]";
+      return info;
+    }
+
+    /*classify the address written by an update for the threads of its region: "same" for
+     * shared scalars and subscripts that don't change, "distinct" for subscripts that
+     * follow the loops of the region or the thread number, "data dependent" for subscripts
+     * computed from data. Returns an empty string for private targets*/
+    std::string classifyContendedAddress(Expr *target, Stmt *region, set<VarDecl*> & varying, set<VarDecl*> & written) {
+      if (VarDecl *VD = getReferencedVar(target)) {
+        if (isPrivateToRegion(VD, target) || (region && isDeclaredInside(VD, region)))
+          return std::string();
+        return "same";
+      }
+      vector<MemAccess> accesses;
+      collectMemAccesses(target, false, true, accesses);
+      if (accesses.empty())
+        return "unknown";
+      vector<pair<Expr*, long long int> > subscripts;
+      getSubscripts(accesses[0], subscripts);
+      std::string address = "same";
+      for (int i = 0, ie = subscripts.size(); i != ie; i++) {
+        if (dependsOnVars(subscripts[i].first, nullptr, varying))
+          return "distinct";
+        if (dependsOnVars(subscripts[i].first, nullptr, written) || hasDependentLoad(subscripts[i].first, nullptr, written))
+          address = "data dependent";
+      }
+      return address;
+    }
+
+    /*Json fields with the contention of a synchronization construct (atomic, critical,
+     * ordered or a lock): its loop depth, the executions per execution of its region,
+     * whether the threads update the same address and whether a reduction or a thread
+     * local accumulation could replace it. The contention score, executions times the
+     * threads that serialize on it, orders the constructs to look at first*/
+    std::string getContentionInfo(Stmt *sync, std::string kind, vector<Stmt*> & protectedStmts) {
+      OMPExecutableDirective *region = getForkingDirective(sync);
+
+      /*loops around the construct, and the ones inside its region change the addresses*/
+      set<VarDecl*> varying, written, innerInductionVars;
+      unsigned int depth = 0;
+      bool insideRegion = (region != nullptr);
+      vector<Stmt*> enclosing;
+      getEnclosingStmts(sync, enclosing);
+      for (int i = 0, ie = enclosing.size(); i != ie; i++) {
+        if (enclosing[i] == region)
+          insideRegion = false;
+        if (!isa<DoStmt>(enclosing[i]) && !isa<ForStmt>(enclosing[i]) && !isa<WhileStmt>(enclosing[i]))
+          continue;
+        depth++;
+        LoopBounds bounds;
+        if (insideRegion && getLoopBounds(enclosing[i], bounds))
+          varying.insert(bounds.inductionVar);
+      }
+      collectThreadIdVars(sync, varying);
+      Stmt *scope = region ? region->getInnermostCapturedStmt()->getCapturedStmt() : (enclosing.empty() ? sync : enclosing.back());
+      collectWrittenVars(scope, written, innerInductionVars);
+      long long int executions = getExecutionsInRegion(sync, region);
+
+      /*targets of the updates protected by the construct*/
+      bool same = false, dataDependent = false, distinct = false, reductions = true;
+      vector<std::string> replacements;
+      for (int k = 0, ke = protectedStmts.size(); k != ke; k++) {
+        vector<Stmt*> nodes_list;
+        visitNodes(protectedStmts[k], nodes_list);
+        for (int i = 0, ie = nodes_list.size(); i != ie; i++) {
+          Expr *target = nullptr;
+          std::string op = std::string();
+          if (BinaryOperator *biop = dyn_cast<BinaryOperator>(nodes_list[i])) {
+            if (!biop->isAssignmentOp())
+              continue;
+            target = biop->getLHS();
+            op = getReductionOp(biop);
+          }
+          else if (UnaryOperator *unop = dyn_cast<UnaryOperator>(nodes_list[i])) {
+            if (!unop->isIncrementDecrementOp())
+              continue;
+            target = unop->getSubExpr();
+            op = "+";
+          }
+          else
+            continue;
+          VarDecl *VD = getReferencedVar(target);
+          if (VD && isDeclaredInside(VD, protectedStmts[k]))
+            continue;
+          std::string address = classifyContendedAddress(target, region, varying, written);
+          if (address.empty())
+            continue;
+          same |= (address == "same");
+          dataDependent |= (address == "data dependent");
+          distinct |= (address == "distinct");
+          if (op.empty())
+            reductions = false;
+          else if (address == "same" && VD)
+            replacements.push_back("reduction(" + op + ":" + VD->getNameAsString() + ")");
+          else if (address == "same" || address == "data dependent")
+            replacements.push_back("thread local accumulation of " + exprToString(target));
+        }
+      }
+
+      std::string address = same ? "true" : (dataDependent ? "data dependent" : (distinct ? "false" : "none"));
+      long long int contending = 1;
+      if (kind != "atomic" || same)
+        contending = machine.threads;
+      else if (dataDependent)
+        contending = 2;
+
+      std::string info = std::string();
+      info += ",\n\"loop depth\":\"" + to_string(depth) + "\"";
+      info += ",\n\"estimated executions\":\"" + ((executions < 0) ? std::string("unknown") : to_string(executions)) + "\"";
+      info += ",\n\"same address\":\"" + address + "\"";
+      if (kind != "ordered" && reductions && replacements.size() > 0)
+        info += ",\n\"replaceable by\":[" + joinJsonList(replacements) + "]";
+      info += ",\n\"contention score\":\"" + ((executions < 0) ? std::string("unknown") : to_string(executions * contending)) + "\"";
+      return info;
+    }
+
+    /*creates a record for the region protected by an OpenMP lock, from omp_set_lock to
+     * the omp_unset_lock call on the same lock in the same block*/
+    void insertLockNode(CallExpr *CE, map<string, string> & clauses) {
+      struct InputFile& currFile = FileStack.top();
+      FunctionDecl *FD = CE->getDirectCallee();
+      if (!FD || (FD->getNameAsString() != "omp_set_lock" && FD->getNameAsString() != "omp_set_nest_lock") ||
+          CE->getNumArgs() != 1 || currFile.visited.count(CE) != 0)
+        return;
+      currFile.visited[CE] = true;
+
+      vector<Stmt*> protectedStmts;
+      vector<Stmt*> enclosing;
+      getEnclosingStmts(CE, enclosing);
+      if (!enclosing.empty()) {
+        if (CompoundStmt *CS = dyn_cast<CompoundStmt>(enclosing[0])) {
+          std::string lock = exprToString(CE->getArg(0));
+          bool found = false;
+          for (auto I = CS->body_begin(), IE = CS->body_end(); I != IE; I++) {
+            CallExpr *unset = dyn_cast<CallExpr>(*I);
+            if (found && unset && unset->getDirectCallee() && unset->getNumArgs() == 1 &&
+                unset->getDirectCallee()->getNameAsString().find("omp_unset") == 0 && exprToString(unset->getArg(0)) == lock)
+              break;
+            if (found)
+              protectedStmts.push_back(*I);
+            if (*I == CE)
+              found = true;
+          }
+        }
+      }
+
+      std::string snippet = std::string();
+      if (ClDCSnippet == true)
+        snippet = getSourceSnippet(CE->getSourceRange(), true, true);
+      std::string fields = ",\n\"lock\":\"" + exprToString(CE->getArg(0)) + "\"";
+      fields += getContentionInfo(CE, "lock", protectedStmts);
+      insertStmtDirectives(CE, "lock", snippet, fields, clauses);
+    }
+
+    /*check if a directive creates a team of threads*/
+    bool isParallelConstruct(Stmt *st) {
+      OMPExecutableDirective *OMPED = dyn_cast<OMPExecutableDirective>(st);
+      if (!OMPED)
+        return false;
+      return isa<OMPParallelDirective>(OMPED) || isa<OMPParallelSectionsDirective>(OMPED) ||
+             isa<OMPTargetParallelDirective>(OMPED) ||
+             classifyPragma(OMPED, false).find("parallel") != std::string::npos;
+    }
+
+    /*number of threads a parallel construct asks for: the num_threads clause when it is
+     * a constant, the threads of the machine description otherwise*/
+    long long int getNumThreads(OMPExecutableDirective *OMPED) {
+      for (int i = 0, ie = OMPED->getNumClauses(); i != ie; i++) {
+        if (OMPNumThreadsClause *OMPcl = dyn_cast<OMPNumThreadsClause>(OMPED->getClause(i))) {
+          long long int threads;
+          if (evaluateInt(OMPcl->getNumThreads(), threads) && threads > 0)
+            return threads;
+        }
+      }
+      return machine.threads;
+    }
+
+    /*maximum number of threads of the parallel constructs reached from a statement,
+     * lexically or through calls to functions defined in the translation unit, or 1
+     * when there are none. The outermost ones are described in the nested list*/
+    long long int getNestedThreads(Stmt *st, set<const FunctionDecl*> & visiting, vector<std::string> & nested) {
+      long long int maxThreads = 1;
+      for (Stmt *child : st->children()) {
+        if (!child)
+          continue;
+        long long int threads = 1;
+        std::string where = " at line " + to_string(astContext->getFullLoc(child->getBeginLoc()).getSpellingLineNumber());
+        OMPExecutableDirective *OMPED = dyn_cast<OMPExecutableDirective>(child);
+        if (OMPED && isParallelConstruct(OMPED)) {
+          vector<std::string> inner;
+          threads = getNumThreads(OMPED);
+          if (OMPED->hasAssociatedStmt())
+            threads *= getNestedThreads(OMPED->getInnermostCapturedStmt()->getCapturedStmt(), visiting, inner);
+          nested.push_back("parallel" + where);
+        }
+        else if (CallExpr *CE = dyn_cast<CallExpr>(child)) {
+          threads = getNestedThreads(CE, visiting, nested);
+          const FunctionDecl *definition = nullptr;
+          FunctionDecl *FD = CE->getDirectCallee();
+          if (FD && FD->hasBody(definition) && visiting.count(definition) == 0) {
+            vector<std::string> inner;
+            visiting.insert(definition);
+            long long int calleeThreads = getNestedThreads(definition->getBody(), visiting, inner);
+            visiting.erase(definition);
+            if (calleeThreads > 1)
+              nested.push_back("call to " + definition->getNameAsString() + where);
+            threads = std::max(threads, calleeThreads);
+          }
+        }
+        /*the children of a directive are its clauses' captures, the region is reached
+         * through its captured statement*/
+        else if (OMPED) {
+          if (OMPED->hasAssociatedStmt())
+            threads = getNestedThreads(OMPED->getInnermostCapturedStmt()->getCapturedStmt(), visiting, nested);
+        }
+        else
+          threads = getNestedThreads(child, visiting, nested);
+        maxThreads = std::max(maxThreads, threads);
+      }
+      return maxThreads;
+    }
+
+    /*Json fields with the nested parallelism of a parallel construct: its num_threads,
+     * the parallel constructs and tasks around it, the parallel constructs reached from
+     * its region (lexically or through calls) and the maximum number of threads of the
+     * whole nest, compared with the threads of the machine*/
+    std::string getNestingInfo(OMPExecutableDirective *construct) {
+      std::string info = std::string();
+      std::string numThreads = "default";
+      bool hardCoded = false;
+      for (int i = 0, ie = construct->getNumClauses(); i != ie; i++) {
+        if (OMPNumThreadsClause *OMPcl = dyn_cast<OMPNumThreadsClause>(construct->getClause(i))) {
+          long long int threads;
+          hardCoded = evaluateInt(OMPcl->getNumThreads(), threads);
+          numThreads = hardCoded ? to_string(threads) : exprToString(OMPcl->getNumThreads());
+        }
+      }
+      info += ",\n\"num threads\":\"" + numThreads + "\"";
+      info += ",\n\"hard coded num threads\":\"" + std::string(hardCoded ? "true" : "false") + "\"";
+
+      /*constructs around it*/
+      long long int maxThreads = getNumThreads(construct);
+      std::string enclosingRegion = std::string();
+      bool insideTask = false;
+      vector<Stmt*> enclosing;
+      getEnclosingStmts(construct, enclosing);
+      for (int i = 0, ie = enclosing.size(); i != ie; i++) {
+        if (isParallelConstruct(enclosing[i])) {
+          maxThreads *= getNumThreads(cast<OMPExecutableDirective>(enclosing[i]));
+          if (enclosingRegion.empty())
+            enclosingRegion = to_string(astContext->getFullLoc(enclosing[i]->getBeginLoc()).getSpellingLineNumber());
+        }
+        if (isa<OMPTaskDirective>(enclosing[i]) || isa<OMPTaskLoopDirective>(enclosing[i]) ||
+            isa<OMPTaskLoopSimdDirective>(enclosing[i]))
+          insideTask = true;
+      }
+      if (!enclosingRegion.empty())
+        info += ",\n\"enclosing parallel region\":\"" + enclosingRegion + "\"";
+      if (insideTask)
+        info += ",\n\"inside task\":\"true\"";
+
+      /*constructs reached from its region*/
+      vector<std::string> nested;
+      set<const FunctionDecl*> visiting;
+      if (construct->hasAssociatedStmt())
+        maxThreads *= getNestedThreads(construct->getInnermostCapturedStmt()->getCapturedStmt(), visiting, nested);
+      if (nested.size() > 0)
+        info += ",\n\"nested parallel regions\":[" + joinJsonList(nested) + "]";
+      info += ",\n\"max threads\":\"" + to_string(maxThreads) + "\"";
+      info += ",\n\"oversubscribed\":\"" + std::string((maxThreads > (long long int) machine.threads) ? "true" : "false") + "\"";
+      return info;
+    }
+
+    /*schedule of a worksharing loop directive, as "static" or "dynamic, 4"*/
+    std::string getScheduleStr(OMPExecutableDirective *OMPED) {
+      map<string, string> clauses;
+      for (int i = 0, ie = OMPED->getNumClauses(); i != ie; i++)
+        ClassifyClause(OMPED->getClause(i), clauses);
+      std::string schedule = (clauses.count("schedule") > 0) ? clauses["schedule"] : "static";
+      if (clauses.count("schedule chunk") > 0)
+        schedule += ", " + clauses["schedule chunk"];
+      return schedule;
+    }
+
+    /*creates a record for each array of a function whose pages are placed by a first
+     * touch that doesn't match the threads using them later: the first loop writing it
+     * is sequential while later worksharing loops access it, or both are worksharing
+     * loops with different schedules. Small arrays, which fit a page, are left out*/
+    void insertFirstTouchNodes(FunctionDecl *FD) {
+      const long long int pageSize = 4096;
+      vector<Stmt*> nodes_list;
+      visitNodes(FD->getBody(), nodes_list);
+
+      /*loops that touch the data: worksharing loops on the host and outermost sequential
+       * loops, in source order. Loops of target regions run on the device*/
+      vector<ValueDecl*> arrays;
+      map<ValueDecl*, Stmt*> firstTouch;
+      map<ValueDecl*, std::string> firstSchedule;
+      map<ValueDecl*, vector<std::string> > parallelUses, mismatches;
+      for (int i = 0, ie = nodes_list.size(); i != ie; i++) {
+        Stmt *loop = nodes_list[i];
+        if (!isa<DoStmt>(loop) && !isa<ForStmt>(loop) && !isa<WhileStmt>(loop))
+          continue;
+        vector<Stmt*> enclosing;
+        getEnclosingStmts(loop, enclosing);
+        bool nested = false, onDevice = false;
+        for (int k = 0, ke = enclosing.size(); k != ke; k++) {
+          nested |= isa<DoStmt>(enclosing[k]) || isa<ForStmt>(enclosing[k]) || isa<WhileStmt>(enclosing[k]);
+          if (OMPExecutableDirective *region = dyn_cast<OMPExecutableDirective>(enclosing[k]))
+            onDevice |= isTargetDirective(region);
+        }
+        if (onDevice)
+          continue;
+        OMPExecutableDirective *OMPED = getLoopDirective(loop);
+        std::string schedule = "sequential";
+        if (OMPED && isa<OMPLoopDirective>(OMPED) && OMPED->getInnermostCapturedStmt()->getCapturedStmt() == loop &&
+            isWorksharingLoop(OMPED) && !isTargetDirective(OMPED))
+          schedule = getScheduleStr(OMPED);
+        else if (OMPED || nested)
+          continue;
+        std::string where = "loop at line " + to_string(astContext->getFullLoc(loop->getBeginLoc()).getSpellingLineNumber());
+
+        vector<MemAccess> accesses;
+        collectMemAccesses(loop, true, false, accesses);
+        for (int k = 0, ke = accesses.size(); k != ke; k++) {
+          ValueDecl *base = accesses[k].base;
+          if (!base || (!base->getType()->isPointerType() && !base->getType()->isArrayType()))
+            continue;
+          if (isa<VarDecl>(base) && isDeclaredInside(cast<VarDecl>(base), loop))
+            continue;
+          if (const ConstantArrayType *CAT = astContext->getAsConstantArrayType(base->getType()))
+            if (astContext->getTypeSizeInChars(CAT).getQuantity() < pageSize)
+              continue;
+          /*accesses of the directives nested in a sequential loop belong to their own
+           * loops (a time loop around a parallel for), which are scanned on their own*/
+          if (schedule == "sequential") {
+            vector<Stmt*> around;
+            getEnclosingStmts(accesses[k].expr, around);
+            bool inDirective = false;
+            for (int j = 0, je = around.size(); j != je && around[j] != loop && !inDirective; j++)
+              inDirective = isa<OMPExecutableDirective>(around[j]);
+            if (inDirective)
+              continue;
+          }
+          if (firstTouch.count(base) == 0) {
+            if (accesses[k].isWrite) {
+              arrays.push_back(base);
+              firstTouch[base] = loop;
+              firstSchedule[base] = schedule;
+            }
+            continue;
+          }
+          if (firstTouch[base] == loop || schedule == "sequential")
+            continue;
+          std::string use = where + " with schedule " + schedule;
+          if (std::find(parallelUses[base].begin(), parallelUses[base].end(), use) != parallelUses[base].end())
+            continue;
+          parallelUses[base].push_back(use);
+          if (firstSchedule[base] != "sequential" && firstSchedule[base] != schedule)
+            mismatches[base].push_back(use);
+        }
+      }
+
+      for (int i = 0, ie = arrays.size(); i != ie; i++) {
+        ValueDecl *base = arrays[i];
+        bool sequential = (firstSchedule[base] == "sequential");
+        if ((sequential && parallelUses[base].empty()) || (!sequential && mismatches[base].empty()))
+          continue;
+        std::string fields = std::string();
+        fields += ",\n\"array\":\"" + base->getNameAsString() + "\"";
+        fields += ",\n\"declaration line\":\"" + to_string(astContext->getFullLoc(base->getLocation()).getSpellingLineNumber()) + "\"";
+        fields += ",\n\"first touch\":\"" + std::string(sequential ? "sequential" : "parallel") + "\"";
+        if (!sequential)
+          fields += ",\n\"first touch schedule\":\"" + firstSchedule[base] + "\"";
+        fields += ",\n\"parallel uses\":[" + joinJsonList(parallelUses[base]) + "]";
+        if (!sequential)
+          fields += ",\n\"mismatched schedules\":[" + joinJsonList(mismatches[base]) + "]";
+        insertRegionNode(firstTouch[base], "first touch", fields);
+      }
+    }
+
+    /*size in bytes of a mapped list item: the product of the lengths of its array
+     * sections times the element size, or the size of the variable. Mapping a pointer
+     * without a section moves no data*/
+    void getMappedBytes(Expr *ex, MappedData & data) {
+      vector<std::string> factors;
+      long long int value = 1;
+      data.sizeKnown = true;
+      int levels = 0;
+      Expr *base = ex->IgnoreParenImpCasts();
+      while (true) {
+        if (OMPArraySectionExpr *OASE = dyn_cast<OMPArraySectionExpr>(base)) {
+          Expr *sectionBase = OASE->getBase()->IgnoreParenImpCasts();
+          long long int length, lower = 0;
+          if (Expr *lengthExpr = OASE->getLength()) {
+            if (evaluateInt(lengthExpr, length))
+              value *= length;
+            else
+              factors.push_back(parenthesize(exprToString(lengthExpr)));
+          }
+          else if (const ConstantArrayType *CAT = astContext->getAsConstantArrayType(sectionBase->getType())) {
+            /*a[lb:] goes to the end of the dimension*/
+            if (!OASE->getLowerBound() || evaluateInt(OASE->getLowerBound(), lower))
+              value *= CAT->getSize().getZExtValue() - lower;
+            else
+              factors.push_back("(" + to_string(CAT->getSize().getZExtValue()) + " - " + parenthesize(exprToString(OASE->getLowerBound())) + ")");
+          }
+          else
+            data.sizeKnown = false;
+          levels++;
+          base = sectionBase;
+        }
+        else if (ArraySubscriptExpr *ASExp = dyn_cast<ArraySubscriptExpr>(base)) {
+          levels++;
+          base = ASExp->getBase()->IgnoreParenImpCasts();
+        }
+        else
+          break;
+      }
+      data.decl = getAccessBase(base);
+
+      QualType type = base->getType();
+      for (int i = 0; i != levels && !type.isNull(); i++) {
+        if (const ArrayType *AT = astContext->getAsArrayType(type))
+          type = AT->getElementType();
+        else if (type->isPointerType())
+          type = type->getPointeeType();
+        else
+          type = QualType();
+      }
+      if (levels == 0 && !type.isNull() && type->isPointerType())
+        value = 0;
+      unsigned int elementBytes = getTypeBytes(type);
+      if (elementBytes == 0 && value != 0)
+        data.sizeKnown = false;
+      value *= elementBytes;
+
+      data.bytesConst = data.sizeKnown && factors.empty();
+      data.bytesValue = value;
+      if (!data.sizeKnown)
+        data.bytes = "unknown";
+      else if (data.bytesConst)
+        data.bytes = to_string(value);
+      else {
+        data.bytes = to_string(value);
+        for (int i = 0, ie = factors.size(); i != ie; i++)
+          data.bytes += " * " + factors[i];
+      }
+    }
+
+    /*list items of the map clauses of a directive, including the implicit ones*/
+    void collectMappedData(OMPExecutableDirective *OMPED, vector<MappedData> & mapped) {
+      for (int i = 0, ie = OMPED->getNumClauses(); i != ie; i++) {
+        OMPMapClause *OMPcl = dyn_cast<OMPMapClause>(OMPED->getClause(i));
+        if (!OMPcl)
+          continue;
+        for (auto I = OMPcl->varlist_begin(), IE = OMPcl->varlist_end(); I != IE; I++) {
+          MappedData data;
+          data.expr = *I;
+          data.mapType = OMPcl->getMapType();
+          data.implicit = OMPcl->isImplicit();
+          getMappedBytes(*I, data);
+          mapped.push_back(data);
+        }
+      }
+    }
+
+    /*name of a map type*/
+    std::string getMapTypeName(OpenMPMapClauseKind mapType) {
+      switch (mapType) {
+        case OMPC_MAP_alloc:
+          return "alloc";
+        case OMPC_MAP_to:
+          return "to";
+        case OMPC_MAP_from:
+          return "from";
+        case OMPC_MAP_tofrom:
+          return "tofrom";
+        case OMPC_MAP_delete:
+          return "delete";
+        case OMPC_MAP_release:
+          return "release";
+        default:
+          return "unknown";
+      }
+    }
+
+    /*the target data directive around a construct that already maps a variable, if any:
+     * the variable is present on the device and isn't moved again*/
+    OMPExecutableDirective *getEnclosingTargetData(Stmt *st, ValueDecl *decl) {
+      vector<Stmt*> enclosing;
+      getEnclosingStmts(st, enclosing);
+      for (int i = 0, ie = enclosing.size(); i != ie; i++) {
+        OMPTargetDataDirective *OMPTD = dyn_cast<OMPTargetDataDirective>(enclosing[i]);
+        if (!OMPTD)
+          continue;
+        vector<MappedData> mapped;
+        collectMappedData(OMPTD, mapped);
+        for (int k = 0, ke = mapped.size(); k != ke; k++)
+          if (mapped[k].decl == decl)
+            return OMPTD;
+      }
+      return nullptr;
+    }
+
+    /*sum of byte counts, some of them symbolic*/
+    std::string sumBytes(vector<MappedData*> & items, long long int & total, bool & constant) {
+      total = 0;
+      constant = true;
+      std::string symbolic = std::string();
+      for (int i = 0, ie = items.size(); i != ie; i++) {
+        if (!items[i]->sizeKnown) {
+          constant = false;
+          return "unknown";
+        }
+        if (items[i]->bytesConst)
+          total += items[i]->bytesValue;
+        else {
+          constant = false;
+          symbolic += (symbolic.empty() ? "" : " + ") + items[i]->bytes;
+        }
+      }
+      if (constant)
+        return to_string(total);
+      return (total == 0) ? symbolic : symbolic + " + " + to_string(total);
+    }
+
+    /*Json fields with the data a target construct moves per launch, from its map clauses.
+     * Variables already mapped by an enclosing target data region aren't moved. When the
+     * kernel is a loop, its work per transferred byte tells if the offload can pay off*/
+    std::string getOffloadVolumeInfo(OMPExecutableDirective *OMPED, Stmt *loop) {
+      vector<MappedData> mapped;
+      collectMappedData(OMPED, mapped);
+      vector<MappedData*> toDevice, fromDevice;
+      vector<std::string> items;
+      for (int i = 0, ie = mapped.size(); i != ie; i++) {
+        std::string item = exprToString(mapped[i].expr) + " (" + getMapTypeName(mapped[i].mapType) +
+                           (mapped[i].implicit ? ", implicit" : "") + "): " + mapped[i].bytes + " bytes";
+        if (OMPExecutableDirective *OMPTD = getEnclosingTargetData(OMPED, mapped[i].decl)) {
+          items.push_back(item + ", present from the target data at line " +
+                          to_string(astContext->getFullLoc(OMPTD->getBeginLoc()).getSpellingLineNumber()));
+          continue;
+        }
+        items.push_back(item);
+        if (mapped[i].mapType == OMPC_MAP_to || mapped[i].mapType == OMPC_MAP_tofrom)
+          toDevice.push_back(&mapped[i]);
+        if (mapped[i].mapType == OMPC_MAP_from || mapped[i].mapType == OMPC_MAP_tofrom)
+          fromDevice.push_back(&mapped[i]);
+      }
+
+      long long int toBytes, fromBytes;
+      bool toConst, fromConst;
+      std::string info = std::string();
+      info += ",\n\"bytes to device\":\"" + sumBytes(toDevice, toBytes, toConst) + "\"";
+      info += ",\n\"bytes from device\":\"" + sumBytes(fromDevice, fromBytes, fromConst) + "\"";
+      if (items.size() > 0)
+        info += ",\n\"mapped data\":[" + joinJsonList(items) + "]";
+
+      double work;
+      if (loop && toConst && fromConst && (toBytes + fromBytes) > 0 && estimateTotalWork(loop, work))
+        info += ",\n\"operations per transferred byte\":\"" + doubleToString(work / (toBytes + fromBytes)) + "\"";
+      return info;
+    }
+
+    /*how the code of a target region uses a mapped variable: the elements it reads and
+     * writes, or the variable itself for scalars. Passing it to a function counts as
+     * both*/
+    void getDeviceUses(Stmt *body, ValueDecl *decl, bool & read, bool & written) {
+      read = false;
+      written = false;
+      vector<MemAccess> accesses;
+      collectMemAccesses(body, true, false, accesses);
+      for (int i = 0, ie = accesses.size(); i != ie; i++) {
+        if (accesses[i].base != decl)
+          continue;
+        read |= accesses[i].isRead;
+        written |= accesses[i].isWrite;
+      }
+      if (!decl->getType()->isPointerType() && !decl->getType()->isArrayType()) {
+        vector<ScalarAccess> scalars;
+        collectScalarAccesses(body, true, false, false, scalars);
+        for (int i = 0, ie = scalars.size(); i != ie; i++) {
+          if (scalars[i].var != decl)
+            continue;
+          read |= scalars[i].isRead;
+          written |= scalars[i].isWrite;
+        }
+      }
+
+      vector<Stmt*> nodes_list;
+      visitNodes(body, nodes_list);
+      for (int i = 0, ie = nodes_list.size(); i != ie; i++) {
+        CallExpr *CE = dyn_cast<CallExpr>(nodes_list[i]);
+        if (!CE || (CE->getDirectCallee() && isKnownMathFunction(CE->getDirectCallee())))
+          continue;
+        for (int k = 0, ke = CE->getNumArgs(); k != ke; k++) {
+          vector<Stmt*> arg_nodes;
+          visitNodes(CE->getArg(k), arg_nodes);
+          for (int j = 0, je = arg_nodes.size(); j != je; j++) {
+            DeclRefExpr *DRex = dyn_cast<DeclRefExpr>(arg_nodes[j]);
+            if (DRex && DRex->getDecl() == decl) {
+              read = true;
+              written = true;
+            }
+          }
+        }
+      }
+    }
+
+    /*check if a statement only runs under a condition or a loop of a region, looking at
+     * the statements between it and the region body*/
+    bool isConditionalInRegion(Stmt *st, Stmt *body) {
+      if (st == body)
+        return false;
+      vector<Stmt*> enclosing;
+      getEnclosingStmts(st, enclosing);
+      for (int i = 0, ie = enclosing.size(); i != ie && enclosing[i] != body; i++) {
+        Stmt *parent = enclosing[i];
+        BinaryOperator *biop = dyn_cast<BinaryOperator>(parent);
+        if (isa<IfStmt>(parent) || isa<SwitchStmt>(parent) || isa<AbstractConditionalOperator>(parent) ||
+            isa<DoStmt>(parent) || isa<ForStmt>(parent) || isa<WhileStmt>(parent) ||
+            (biop && biop->isLogicalOp()))
+          return true;
+      }
+      return false;
+    }
+
+    /*check if a target region writes every element of a mapped item before the end of
+     * the region: a scalar assigned unconditionally before any read, or a one dimension
+     * section written as a[i + c] by an unconditional loop with unit step whose iterations
+     * cover exactly the section*/
+    bool isFullyWritten(Stmt *body, MappedData & item) {
+      ValueDecl *decl = item.decl;
+      if (!decl->getType()->isPointerType() && !decl->getType()->isArrayType()) {
+        vector<ScalarAccess> scalars;
+        collectScalarAccesses(body, true, false, false, scalars);
+        for (int i = 0, ie = scalars.size(); i != ie; i++)
+          if (scalars[i].var == decl)
+            return scalars[i].isWrite && !scalars[i].isRead && !scalars[i].conditional &&
+                   !isConditionalInRegion(scalars[i].ref, body);
+        return false;
+      }
+
+      /*bounds of the section: a[lb:len], or a whole one dimension array*/
+      std::string lower = "0", length;
+      Expr *ex = item.expr->IgnoreParenImpCasts();
+      if (OMPArraySectionExpr *OASE = dyn_cast<OMPArraySectionExpr>(ex)) {
+        if (!isa<DeclRefExpr>(OASE->getBase()->IgnoreParenImpCasts()) || !OASE->getLength())
+          return false;
+        if (OASE->getLowerBound())
+          lower = getClauseValue(OASE->getLowerBound());
+        length = getClauseValue(OASE->getLength());
+      }
+      else if (const ConstantArrayType *CAT = astContext->getAsConstantArrayType(decl->getType())) {
+        if (CAT->getElementType()->isArrayType())
+          return false;
+        length = to_string(CAT->getSize().getZExtValue());
+      }
+      else
+        return false;
+
+      vector<MemAccess> accesses;
+      collectMemAccesses(body, true, false, accesses);
+      set<VarDecl*> none;
+      for (int i = 0, ie = accesses.size(); i != ie; i++) {
+        ArraySubscriptExpr *ASExp = dyn_cast<ArraySubscriptExpr>(accesses[i].expr->IgnoreParenImpCasts());
+        if (accesses[i].base != decl || !accesses[i].isWrite || !ASExp ||
+            !isa<DeclRefExpr>(ASExp->getBase()->IgnoreParenImpCasts()))
+          continue;
+
+        /*the loop running the write, reached without conditions*/
+        vector<Stmt*> enclosing;
+        getEnclosingStmts(accesses[i].expr, enclosing);
+        Stmt *loop = nullptr;
+        bool conditional = false;
+        for (int k = 0, ke = enclosing.size(); k != ke && !loop; k++) {
+          BinaryOperator *biop = dyn_cast<BinaryOperator>(enclosing[k]);
+          if (isa<ForStmt>(enclosing[k]))
+            loop = enclosing[k];
+          else if (isa<IfStmt>(enclosing[k]) || isa<SwitchStmt>(enclosing[k]) || isa<AbstractConditionalOperator>(enclosing[k]) ||
+                   isa<DoStmt>(enclosing[k]) || isa<WhileStmt>(enclosing[k]) || (biop && biop->isLogicalOp()) ||
+                   enclosing[k] == body)
+            conditional = true;
+        }
+        LoopBounds bounds;
+        if (conditional || !loop || isConditionalInRegion(loop, body) || !getLoopBounds(loop, bounds) ||
+            !bounds.stepConst || bounds.stepValue != 1)
+          continue;
+        bool exits = false;
+        vector<Stmt*> nodes_list;
+        visitNodes(getLoopBody(loop), nodes_list);
+        for (int k = 0, ke = nodes_list.size(); k != ke; k++)
+          exits |= isEarlyExit(nodes_list[k], loop) || isa<ContinueStmt>(nodes_list[k]);
+        if (exits)
+          continue;
+
+        AffineSubscript subscript;
+        if (!getAffineSubscript(ASExp->getIdx(), bounds.inductionVar, none, none, subscript) ||
+            subscript.coefficient != 1 || !subscript.symbolic.empty())
+          continue;
+        std::string start = bounds.lowerConst ? to_string(bounds.lowerValue + subscript.offset) :
+                            ((subscript.offset == 0) ? bounds.lower : std::string());
+        if (start == lower && bounds.tripCount == length)
+          return true;
+      }
+      return false;
+    }
+
+    /*Json fields with the map types of a target construct that move more data than the
+     * region needs: variables only read need "to", variables only written need "from"
+     * (only when the region provably writes all of the mapped elements, otherwise the
+     * stale device memory would be copied back) and unused ones need "alloc"*/
+    std::string getMapNarrowingInfo(OMPExecutableDirective *OMPED) {
+      if (!OMPED->hasAssociatedStmt())
+        return std::string();
+      Stmt *body = OMPED->getInnermostCapturedStmt()->getCapturedStmt();
+      vector<MappedData> mapped;
+      collectMappedData(OMPED, mapped);
+
+      vector<std::string> narrowing;
+      vector<MappedData> saved;
+      for (int i = 0, ie = mapped.size(); i != ie; i++) {
+        OpenMPMapClauseKind mapType = mapped[i].mapType;
+        if (!mapped[i].decl || (mapType != OMPC_MAP_to && mapType != OMPC_MAP_from && mapType != OMPC_MAP_tofrom))
+          continue;
+        if (getEnclosingTargetData(OMPED, mapped[i].decl))
+          continue;
+        bool read, written;
+        getDeviceUses(body, mapped[i].decl, read, written);
+        bool copyIn = (mapType == OMPC_MAP_to || mapType == OMPC_MAP_tofrom);
+        bool copyOut = (mapType == OMPC_MAP_from || mapType == OMPC_MAP_tofrom);
+        bool needIn = copyIn && read;
+        bool needOut = copyOut && written;
+        if (needIn == copyIn && needOut == copyOut)
+          continue;
+
+        std::string narrowed = (needIn && needOut) ? "tofrom" : (needIn ? "to" : (needOut ? "from" : "alloc"));
+        if (narrowed == "from" && !isFullyWritten(body, mapped[i]))
+          continue;
+        unsigned int copies = (copyIn && !needIn) + (copyOut && !needOut);
+        MappedData bytes = mapped[i];
+        if (bytes.bytesConst) {
+          bytes.bytesValue *= copies;
+          bytes.bytes = to_string(bytes.bytesValue);
+        }
+        else if (bytes.sizeKnown && copies > 1)
+          bytes.bytes = "2 * " + parenthesize(bytes.bytes);
+        saved.push_back(bytes);
+        narrowing.push_back(exprToString(mapped[i].expr) + ": " + getMapTypeName(mapType) + " -> " + narrowed +
+                            ", saves " + bytes.bytes + " bytes");
+      }
+      if (narrowing.empty())
+        return std::string();
+
+      vector<MappedData*> savedItems;
+      for (int i = 0, ie = saved.size(); i != ie; i++)
+        savedItems.push_back(&saved[i]);
+      long long int total;
+      bool constant;
+      std::string info = ",\n\"map narrowing\":[" + joinJsonList(narrowing) + "]";
+      info += ",\n\"bytes saved per launch\":\"" + sumBytes(savedItems, total, constant) + "\"";
+      return info;
+    }
+
+    /*loops of the perfect nest starting at a loop: each one is the only statement of
+     * the body of the previous one*/
+    void getPerfectNest(Stmt *loop, vector<Stmt*> & nest) {
+      while (loop && (isa<DoStmt>(loop) || isa<ForStmt>(loop) || isa<WhileStmt>(loop))) {
+        nest.push_back(loop);
+        Stmt *body = getLoopBody(loop);
+        while (CompoundStmt *CS = dyn_cast_or_null<CompoundStmt>(body)) {
+          if (CS->size() != 1)
+            return;
+          body = CS->body_front();
+        }
+        loop = body;
+      }
+    }
+
+    /*number of loops associated to a directive by its collapse clause, 1 without it or
+     * when it can't be folded*/
+    long long int getCollapseDepth(OMPExecutableDirective *OMPED) {
+      long long int collapse = 1;
+      for (int i = 0, ie = OMPED->getNumClauses(); i != ie; i++)
+        if (OMPCollapseClause *OMPcl = dyn_cast<OMPCollapseClause>(OMPED->getClause(i)))
+          if (!evaluateInt(OMPcl->getNumForLoops(), collapse) || collapse < 1)
+            collapse = 1;
+      return collapse;
+    }
+
+    /*Json fields with the loop nest of a worksharing loop: the canonical loops perfectly
+     * nested in it, whether their bounds depend on outer induction variables, and the
+     * iterations the collapsed levels give to the threads. When they can't feed all
+     * threads, the smallest collapse that can is recommended. Levels whose trip count is
+     * only known at runtime are assumed to be large enough*/
+    std::string getCollapseInfo(OMPExecutableDirective *OMPED) {
+      Stmt *st = OMPED->getInnermostCapturedStmt()->getCapturedStmt();
+      vector<Stmt*> nest;
+      getPerfectNest(st, nest);
+
+      long long int collapse = getCollapseDepth(OMPED);
+      long long int threads = machine.threads;
+      OMPExecutableDirective *construct = getForkingDirective(OMPED);
+      if (construct && isParallelConstruct(construct))
+        threads = getNumThreads(construct);
+
+      /*levels of the nest, up to the first loop that isn't in canonical form*/
+      vector<LoopBounds> levels;
+      vector<std::string> description, nonRectangular;
+      set<VarDecl*> outerVars, none;
+      for (int i = 0, ie = nest.size(); i != ie; i++) {
+        LoopBounds bounds;
+        if (!isa<ForStmt>(nest[i]) || !getLoopBounds(nest[i], bounds))
+          break;
+        bool rectangular = true;
+        for (set<VarDecl*>::iterator I = outerVars.begin(), IE = outerVars.end(); I != IE; I++)
+          rectangular &= !dependsOnVars(bounds.lowerExpr, *I, none) && !dependsOnVars(bounds.upperExpr, *I, none);
+        if (!rectangular)
+          nonRectangular.push_back(bounds.inductionVar->getNameAsString());
+        description.push_back(bounds.inductionVar->getNameAsString() + ": " + bounds.tripCount);
+        outerVars.insert(bounds.inductionVar);
+        levels.push_back(bounds);
+      }
+      if (levels.empty())
+        return std::string();
+
+      /*iterations handed to the threads by the current collapse*/
+      long long int iterations = 1;
+      bool iterationsKnown = true;
+      for (int i = 0, ie = levels.size(); i != ie && i < collapse; i++) {
+        if (levels[i].tripConst)
+          iterations *= levels[i].tripValue;
+        else
+          iterationsKnown = false;
+      }
+
+      std::string recommended = "none";
+      if (iterationsKnown && iterations < threads) {
+        long long int collapsed = iterations;
+        for (int i = collapse, ie = levels.size(); i < ie; i++) {
+          collapsed = levels[i].tripConst ? collapsed * levels[i].tripValue : threads;
+          if (collapsed >= threads) {
+            recommended = "collapse(" + to_string(i + 1) + ")";
+            break;
+          }
+        }
+      }
+
+      std::string info = std::string();
+      info += ",\n\"loop nest\":[" + joinJsonList(description) + "]";
+      info += ",\n\"perfect nest depth\":\"" + to_string(levels.size()) + "\"";
+      info += ",\n\"rectangular nest\":\"" + std::string(nonRectangular.empty() ? "true" : "false") + "\"";
+      if (!nonRectangular.empty())
+        info += ",\n\"non rectangular levels\":[" + joinJsonList(nonRectangular) + "]";
+      info += ",\n\"outer trip count\":\"" + levels[0].tripCount + "\"";
+      info += ",\n\"threads to feed\":\"" + to_string(threads) + "\"";
+      info += ",\n\"iterations to share\":\"" + (iterationsKnown ? to_string(iterations) : std::string("unknown")) + "\"";
+      info += ",\n\"collapse recommended\":\"" + recommended + "\"";
+      /*collapsing loops with bounds that depend on outer ones needs OpenMP 5.0*/
+      if (recommended != "none" && !nonRectangular.empty())
+        info += ",\n\"collapse requires\":\"OpenMP 5.0\"";
+      return info;
+    }
+
+    /*check if a loop is the only statement of the body of a canonical for loop, so the
+     * nest is reported from the outer one*/
+    bool isPerfectlyNested(Stmt *st) {
+      vector<Stmt*> enclosing;
+      getEnclosingStmts(st, enclosing);
+      for (int i = 0, ie = enclosing.size(); i != ie; i++) {
+        CompoundStmt *CS = dyn_cast<CompoundStmt>(enclosing[i]);
+        if (CS && CS->size() == 1)
+          continue;
+        LoopBounds bounds;
+        return isa<ForStmt>(enclosing[i]) && getLoopBounds(enclosing[i], bounds);
+      }
+      return false;
+    }
+
+    /*Json fields with a loop interchange that makes the innermost accesses of a perfect
+     * nest unit stride: each level is tried as the innermost one, counting the accesses
+     * of the body that would still have a non unit stride (a[i][j] or a[j*n+i] with i
+     * innermost). The interchange is legal when no loop of the band it permutes carries
+     * a dependence, and the directive of the nest doesn't fix the iteration order*/
+    std::string getInterchangeInfo(Stmt *st, OMPExecutableDirective *OMPED) {
+      if (isPerfectlyNested(st))
+        return std::string();
+      vector<Stmt*> nest;
+      getPerfectNest(st, nest);
+      vector<VarDecl*> vars;
+      for (int i = 0, ie = nest.size(); i != ie; i++) {
+        LoopBounds bounds;
+        if (!isa<ForStmt>(nest[i]) || !getLoopBounds(nest[i], bounds))
+          break;
+        vars.push_back(bounds.inductionVar);
+      }
+      if (vars.size() < 2)
+        return std::string();
+      nest.resize(vars.size());
+
+      /*strided accesses of the body with each level as the innermost one*/
+      Stmt *body = getLoopBody(nest.back());
+      set<VarDecl*> written, innerInductionVars;
+      vector<MemAccess> accesses;
+      collectWrittenVars(getLoopBody(st), written, innerInductionVars);
+      for (int i = 0, ie = vars.size(); i != ie; i++)
+        written.erase(vars[i]);
+      collectMemAccesses(body, true, false, accesses);
+      vector<int> strided(vars.size(), 0);
+      for (int k = 0, ke = vars.size(); k != ke; k++) {
+        for (int i = 0, ie = accesses.size(); i != ie; i++) {
+          classifyAccess(accesses[i], vars[k], written);
+          if (accesses[i].pattern == "constant stride")
+            strided[k]++;
+        }
+      }
+      int innermost = vars.size() - 1;
+      int best = innermost;
+      for (int k = innermost - 1; k >= 0; k--)
+        if (strided[k] < strided[best])
+          best = k;
+      if (best == innermost)
+        return std::string();
+
+      /*accesses fixed by the interchange*/
+      vector<std::string> fixed;
+      for (int i = 0, ie = accesses.size(); i != ie; i++) {
+        classifyAccess(accesses[i], vars[innermost], written);
+        if (accesses[i].pattern != "constant stride")
+          continue;
+        classifyAccess(accesses[i], vars[best], written);
+        if (accesses[i].pattern == "unit stride" || accesses[i].pattern == "invariant")
+          fixed.push_back(exprToString(accesses[i].expr));
+      }
+
+      /*the permuted band must be free of carried dependences and rectangular*/
+      vector<std::string> blockers, notes;
+      set<VarDecl*> none;
+      for (int k = best, ke = vars.size(); k != ke; k++) {
+        DependenceInfo & info = getDependences(nest[k]);
+        if (info.verdict == "dependent")
+          blockers.push_back("loop " + vars[k]->getNameAsString() + " carries dependences");
+        else if (info.verdict == "reduction parallel")
+          notes.push_back("loop " + vars[k]->getNameAsString() + " reassociates reductions");
+      }
+      /*in the new order no loop can have bounds depending on a loop inside it*/
+      for (int k = 0, ke = vars.size(); k != ke; k++) {
+        int position = (k == best) ? innermost : ((k == innermost) ? best : k);
+        LoopBounds bounds;
+        getLoopBounds(nest[k], bounds);
+        for (int l = 0, le = vars.size(); l != le; l++) {
+          int inner = (l == best) ? innermost : ((l == innermost) ? best : l);
+          if (inner > position && (dependsOnVars(bounds.lowerExpr, vars[l], none) || dependsOnVars(bounds.upperExpr, vars[l], none)))
+            blockers.push_back("bounds of " + vars[k]->getNameAsString() + " depend on " + vars[l]->getNameAsString());
+        }
+      }
+      if (OMPED) {
+        for (int i = 0, ie = OMPED->getNumClauses(); i != ie; i++) {
+          if (isa<OMPOrderedClause>(OMPED->getClause(i)))
+            blockers.push_back("ordered clause");
+          if (isa<OMPLastprivateClause>(OMPED->getClause(i)))
+            notes.push_back("lastprivate values come from a different last iteration");
+        }
+        if (best < getCollapseDepth(OMPED) && getCollapseDepth(OMPED) <= innermost)
+          notes.push_back("the directive would distribute loop " + vars[innermost]->getNameAsString());
+      }
+
+      vector<std::string> order;
+      for (int k = 0, ke = vars.size(); k != ke; k++)
+        order.push_back(vars[(k == best) ? innermost : ((k == innermost) ? best : k)]->getNameAsString());
+
+      std::string info = std::string();
+      info += ",\n\"interchange recommended\":\"true\"";
+      info += ",\n\"suggested loop order\":[" + joinJsonList(order) + "]";
+      info += ",\n\"strided accesses\":\"" + to_string(strided[innermost]) + "\"";
+      info += ",\n\"strided accesses after interchange\":\"" + to_string(strided[best]) + "\"";
+      if (fixed.size() > 0)
+        info += ",\n\"accesses made contiguous\":[" + joinJsonList(fixed) + "]";
+      info += ",\n\"interchange legal\":\"" + std::string(blockers.empty() ? "true" : "false") + "\"";
+      if (blockers.size() > 0)
+        info += ",\n\"interchange blockers\":[" + joinJsonList(blockers) + "]";
+      if (notes.size() > 0)
+        info += ",\n\"interchange notes\":[" + joinJsonList(notes) + "]";
+      return info;
+    }
+
+    /*declared number of elements of the array dimension an access indexes with the
+     * given variable, or 0 when it isn't a constant size array*/
+    long long int getDeclaredExtent(MemAccess & access, VarDecl *var) {
+      set<VarDecl*> none;
+      Expr *cur = access.expr->IgnoreParenImpCasts();
+      while (MemberExpr *MEx = dyn_cast<MemberExpr>(cur)) {
+        if (MEx->isArrow())
+          return 0;
+        cur = MEx->getBase()->IgnoreParenImpCasts();
+      }
+      while (ArraySubscriptExpr *ASExp = dyn_cast<ArraySubscriptExpr>(cur)) {
+        Expr *base = ASExp->getBase()->IgnoreParenImpCasts();
+        if (dependsOnVars(ASExp->getIdx(), var, none))
+          if (const ConstantArrayType *CAT = astContext->getAsConstantArrayType(base->getType()))
+            return CAT->getSize().getZExtValue();
+        cur = base;
+      }
+      return 0;
+    }
+
+    /*iterations of a loop between two accesses to the same elements of an array, as
+     * a[i-1][j] and a[i+1][j] across i, or 0 when they never touch the same ones*/
+    long long int getReuseDistance(MemAccess & first, MemAccess & second, VarDecl *var, set<VarDecl*> & written) {
+      if (first.base != second.base || getFieldPath(first.expr) != getFieldPath(second.expr))
+        return 0;
+      vector<pair<Expr*, long long int> > firstSubs, secondSubs;
+      getSubscripts(first, firstSubs);
+      getSubscripts(second, secondSubs);
+      if (firstSubs.size() != secondSubs.size())
+        return 0;
+      set<VarDecl*> none;
+      long long int distance = 0;
+      for (int k = 0, ke = firstSubs.size(); k != ke; k++) {
+        AffineSubscript a, b;
+        if (!getAffineSubscript(firstSubs[k].first, var, written, none, a) ||
+            !getAffineSubscript(secondSubs[k].first, var, written, none, b) ||
+            a.symbolic != b.symbolic || a.coefficient != b.coefficient)
+          return 0;
+        long long int delta = b.offset - a.offset;
+        if (a.coefficient == 0) {
+          if (delta != 0)
+            return 0;
+          continue;
+        }
+        if (delta % a.coefficient != 0)
+          return 0;
+        long long int d = delta / a.coefficient;
+        if (distance != 0 && d != 0 && d != distance)
+          return 0;
+        if (d != 0)
+          distance = d;
+      }
+      return std::abs(distance);
+    }
+
+    /*bytes touched by one iteration of a level of a nest (-1 for the whole nest): each
+     * array counts its largest access, spanning the trip count (or tile) of every inner
+     * level it moves with. Accesses strided in the innermost level take a cache line per
+     * element. Returns -1 when some trip count is unknown*/
+    long long int getFootprint(vector<MemAccess> & accesses, vector<vector<std::string> > & patterns,
+                               vector<long long int> & trips, int level, long long int tile) {
+      int innermost = trips.size() - 1;
+      map<ValueDecl*, long long int> perBase;
+      for (int i = 0, ie = accesses.size(); i != ie; i++) {
+        long long int elements = 1;
+        for (int l = level + 1; l <= innermost; l++) {
+          if (patterns[i][l] == "invariant")
+            continue;
+          long long int trip = trips[l];
+          if (tile > 0 && (trip == 0 || trip > tile))
+            trip = tile;
+          if (trip == 0)
+            return -1;
+          elements = std::min(elements * trip, 1LL << 40);
+        }
+        long long int elementBytes = accesses[i].bytes;
+        if (patterns[i][innermost] == "constant stride")
+          elementBytes = std::max(elementBytes, (long long int) machine.cacheLine);
+        perBase[accesses[i].base] = std::max(perBase[accesses[i].base], elements * elementBytes);
+      }
+      long long int bytes = 0;
+      for (map<ValueDecl*, long long int>::iterator I = perBase.begin(), IE = perBase.end(); I != IE; I++)
+        bytes += I->second;
+      return bytes;
+    }
+
+    /*cache level a working set fits in*/
+    std::string getCacheLevel(long long int bytes) {
+      if (bytes < 0)
+        return "unknown";
+      if (bytes <= machine.l1Cache)
+        return "L1";
+      if (bytes <= machine.l2Cache)
+        return "L2";
+      return "memory";
+    }
+
+    /*Json fields with the tiling opportunities of a perfect nest. Each level is checked
+     * for reuse it carries: temporal (an access invariant in the level), group (stencil
+     * neighbours as a[i-1][j] and a[i+1][j]) or spatial (unit stride in the level but
+     * strided in the innermost one, as in transposes). The reuse distance is the data
+     * touched by the inner levels between two uses; trip counts come from the bounds or
+     * from the declared array sizes, and unknown ones are assumed to be large. The
+     * innermost level whose reuse doesn't fit in L1 is tiled together with the levels
+     * inside it, with tiles that keep the reuse in half of L1*/
+    std::string getTilingInfo(Stmt *st, OMPExecutableDirective *OMPED) {
+      if (isPerfectlyNested(st))
+        return std::string();
+      vector<Stmt*> nest;
+      getPerfectNest(st, nest);
+      vector<VarDecl*> vars;
+      vector<LoopBounds> levels;
+      for (int i = 0, ie = nest.size(); i != ie; i++) {
+        LoopBounds bounds;
+        if (!isa<ForStmt>(nest[i]) || !getLoopBounds(nest[i], bounds))
+          break;
+        vars.push_back(bounds.inductionVar);
+        levels.push_back(bounds);
+      }
+      if (vars.size() < 2)
+        return std::string();
+      nest.resize(vars.size());
+      int innermost = vars.size() - 1;
+
+      set<VarDecl*> written, innerInductionVars;
+      vector<MemAccess> accesses;
+      collectWrittenVars(getLoopBody(st), written, innerInductionVars);
+      for (int i = 0, ie = vars.size(); i != ie; i++)
+        written.erase(vars[i]);
+      collectMemAccesses(getLoopBody(nest.back()), true, false, accesses);
+      if (accesses.empty())
+        return std::string();
+
+      /*trip counts, from the bounds or from the declared extents*/
+      vector<long long int> trips(vars.size(), 0);
+      for (int l = 0, le = vars.size(); l != le; l++) {
+        if (levels[l].tripConst) {
+          trips[l] = levels[l].tripValue;
+          continue;
+        }
+        for (int i = 0, ie = accesses.size(); i != ie; i++) {
+          long long int extent = getDeclaredExtent(accesses[i], vars[l]);
+          if (extent > 0 && (trips[l] == 0 || extent < trips[l]))
+            trips[l] = extent;
+        }
+      }
+      vector<vector<std::string> > patterns(accesses.size(), vector<std::string>(vars.size()));
+      for (int i = 0, ie = accesses.size(); i != ie; i++) {
+        for (int l = 0, le = vars.size(); l != le; l++) {
+          classifyAccess(accesses[i], vars[l], written);
+          patterns[i][l] = accesses[i].pattern;
+        }
+      }
+
+      /*reuse carried by each level*/
+      vector<std::string> reuse, workingSets;
+      vector<long long int> distances(vars.size(), 0);
+      int tileLevel = -1;
+      for (int k = 0; k != innermost; k++) {
+        std::string kinds = std::string();
+        for (int i = 0, ie = accesses.size(); i != ie; i++) {
+          bool moves = false;
+          for (int l = k + 1; l <= innermost; l++)
+            moves |= (patterns[i][l] != "invariant");
+          if (patterns[i][k] == "invariant" && moves && kinds.find("temporal") == std::string::npos) {
+            kinds += " temporal";
+            distances[k] = std::max(distances[k], 1LL);
+          }
+          if (patterns[i][k] == "unit stride" && patterns[i][innermost] == "constant stride" && kinds.find("spatial") == std::string::npos) {
+            kinds += " spatial";
+            distances[k] = std::max(distances[k], 1LL);
+          }
+          for (int j = i + 1; j != ie; j++) {
+            long long int distance = getReuseDistance(accesses[i], accesses[j], vars[k], written);
+            if (distance == 0)
+              continue;
+            if (kinds.find("group") == std::string::npos)
+              kinds += " group";
+            distances[k] = std::max(distances[k], distance);
+          }
+        }
+        if (distances[k] == 0)
+          continue;
+        long long int footprint = getFootprint(accesses, patterns, trips, k, 0);
+        long long int bytes = (footprint < 0) ? -1 : distances[k] * footprint;
+        reuse.push_back(vars[k]->getNameAsString() + ":" + kinds + ", distance " + to_string(distances[k]) + " iterations, " +
+                        ((bytes < 0) ? std::string("unknown") : to_string(bytes)) + " bytes, fits in " + getCacheLevel(bytes));
+        if (bytes < 0 || bytes > machine.l1Cache)
+          tileLevel = k;
+      }
+      if (reuse.empty())
+        return std::string();
+
+      long long int total = getFootprint(accesses, patterns, trips, -1, 0);
+      workingSets.push_back("nest: " + ((total < 0) ? std::string("unknown") : to_string(total)));
+      for (int k = 0; k != innermost; k++) {
+        long long int footprint = getFootprint(accesses, patterns, trips, k, 0);
+        workingSets.push_back(vars[k]->getNameAsString() + ": " + ((footprint < 0) ? std::string("unknown") : to_string(footprint)));
+      }
+
+      std::string info = std::string();
+      info += ",\n\"working set per level\":[" + joinJsonList(workingSets) + "]";
+      info += ",\n\"reuse per level\":[" + joinJsonList(reuse) + "]";
+      info += ",\n\"tiling recommended\":\"" + std::string((tileLevel >= 0) ? "true" : "false") + "\"";
+      if (tileLevel < 0)
+        return info;
+
+      /*largest power of two tile that keeps the reuse in half of L1*/
+      long long int tile = 256;
+      for (; tile > 8; tile /= 2) {
+        long long int footprint = getFootprint(accesses, patterns, trips, tileLevel, tile);
+        if (footprint >= 0 && distances[tileLevel] * footprint <= machine.l1Cache / 2)
+          break;
+      }
+
+      /*the tiled band must be permutable and rectangular*/
+      vector<std::string> band, sizes, blockers;
+      set<VarDecl*> bandVars, none;
+      for (int k = tileLevel; k <= innermost; k++) {
+        if (getDependences(nest[k]).verdict == "dependent")
+          blockers.push_back("loop " + vars[k]->getNameAsString() + " carries dependences");
+        for (set<VarDecl*>::iterator I = bandVars.begin(), IE = bandVars.end(); I != IE; I++)
+          if (dependsOnVars(levels[k].lowerExpr, *I, none) || dependsOnVars(levels[k].upperExpr, *I, none))
+            blockers.push_back("bounds of " + vars[k]->getNameAsString() + " depend on " + (*I)->getNameAsString());
+        bandVars.insert(vars[k]);
+        band.push_back(vars[k]->getNameAsString());
+        sizes.push_back(to_string(tile));
+      }
+      bool ompTile = blockers.empty();
+      if (OMPED) {
+        for (int i = 0, ie = OMPED->getNumClauses(); i != ie; i++)
+          ompTile &= !isa<OMPOrderedClause>(OMPED->getClause(i));
+        /*the tile construct can't split the loops collapsed by the directive*/
+        ompTile &= (tileLevel == 0 || tileLevel >= getCollapseDepth(OMPED));
+      }
+
+      info += ",\n\"tile levels\":[" + joinJsonList(band) + "]";
+      info += ",\n\"tile sizes\":[" + joinJsonList(sizes) + "]";
+      info += ",\n\"tiling legal\":\"" + std::string(blockers.empty() ? "true" : "false") + "\"";
+      if (blockers.size() > 0)
+        info += ",\n\"tiling blockers\":[" + joinJsonList(blockers) + "]";
+      info += ",\n\"omp tile applies\":\"" + std::string(ompTile ? "true" : "false") + "\"";
+      if (ompTile) {
+        std::string pragma = "#pragma omp tile sizes(" + sizes[0];
+        for (int i = 1, ie = sizes.size(); i != ie; i++)
+          pragma += ", " + sizes[i];
+        info += ",\n\"tile pragma\":\"" + pragma + ")\"";
+      }
+      return info;
+    }
+
+    /*value of an integer clause expression, folded when possible*/
+    std::string getClauseValue(Expr *ex) {
+      long long int value;
+      if (evaluateInt(ex, value))
+        return to_string(value);
+      return exprToString(ex);
+    }
+
+    /*Json fields with the shape of an offloaded kernel: the parallel levels it uses,
+     * num_teams and thread_limit, the collapse depth against the perfectly nested loops,
+     * the trip count of each level and the conditionals of the innermost level, which
+     * make the threads diverge when they depend on the iteration*/
+    std::string getKernelShapeInfo(OMPExecutableDirective *target) {
+      if (!target->hasAssociatedStmt())
+        return std::string();
+
+      /*directives of the kernel: the target construct and the ones nested in it*/
+      vector<OMPExecutableDirective*> directives(1, target);
+      vector<Stmt*> nodes_list;
+      visitNodes(target->getInnermostCapturedStmt()->getCapturedStmt(), nodes_list);
+      for (int i = 0, ie = nodes_list.size(); i != ie; i++)
+        if (OMPExecutableDirective *OMPED = dyn_cast<OMPExecutableDirective>(nodes_list[i]))
+          directives.push_back(OMPED);
+
+      bool teams = false, distribute = false, parallel = false, parallelFor = false, simd = false;
+      std::string numTeams = "default", threadLimit = "default";
+      vector<OMPExecutableDirective*> loopDirectives;
+      for (int i = 0, ie = directives.size(); i != ie; i++) {
+        OMPExecutableDirective *OMPED = directives[i];
+        OpenMPDirectiveKind kind = OMPED->getDirectiveKind();
+        teams |= isOpenMPTeamsDirective(kind);
+        distribute |= isOpenMPDistributeDirective(kind);
+        parallel |= isOpenMPParallelDirective(kind);
+        parallelFor |= isOpenMPLoopDirective(kind) && isOpenMPWorksharingDirective(kind);
+        simd |= isOpenMPSimdDirective(kind);
+        if (isa<OMPLoopDirective>(OMPED))
+          loopDirectives.push_back(OMPED);
+        for (int k = 0, ke = OMPED->getNumClauses(); k != ke; k++) {
+          OMPClause *clause = OMPED->getClause(k);
+          if (OMPNumTeamsClause *OMPcl = dyn_cast<OMPNumTeamsClause>(clause))
+            numTeams = getClauseValue(OMPcl->getNumTeams());
+          if (OMPThreadLimitClause *OMPcl = dyn_cast<OMPThreadLimitClause>(clause))
+            threadLimit = getClauseValue(OMPcl->getThreadLimit());
+        }
+      }
+
+      vector<std::string> levels;
+      if (teams)
+        levels.push_back("teams");
+      if (distribute)
+        levels.push_back("distribute");
+      if (parallelFor)
+        levels.push_back("parallel for");
+      else if (parallel)
+        levels.push_back("parallel");
+      if (simd)
+        levels.push_back("simd");
+
+      std::string info = std::string();
+      info += ",\n\"parallel levels\":[" + joinJsonList(levels) + "]";
+      info += ",\n\"num teams\":\"" + numTeams + "\"";
+      info += ",\n\"thread limit\":\"" + threadLimit + "\"";
+      if (loopDirectives.empty())
+        return info;
+
+      /*loops of each loop directive of the kernel, with the collapsed ones first. The
+       * outermost directive gives the shape of the kernel, all of them are listed*/
+      vector<std::string> loopShapes;
+      vector<Stmt*> nest;
+      vector<std::string> tripCounts;
+      long long int collapse = 1, collapsedIterations = 1;
+      bool iterationsKnown = true;
+      for (int d = loopDirectives.size() - 1; d >= 0; d--) {
+        nest.clear();
+        tripCounts.clear();
+        collapse = getCollapseDepth(loopDirectives[d]);
+        collapsedIterations = 1;
+        iterationsKnown = true;
+        getPerfectNest(loopDirectives[d]->getInnermostCapturedStmt()->getCapturedStmt(), nest);
+        for (int i = 0, ie = nest.size(); i != ie; i++) {
+          LoopBounds bounds;
+          bool canonical = getLoopBounds(nest[i], bounds);
+          tripCounts.push_back(canonical ? bounds.tripCount : "unknown");
+          if (i < collapse) {
+            if (canonical && bounds.tripConst)
+              collapsedIterations *= bounds.tripValue;
+            else
+              iterationsKnown = false;
+          }
+        }
+        std::string shape = classifyPragma(loopDirectives[d], false) + " at line " +
+                            to_string(astContext->getFullLoc(loopDirectives[d]->getBeginLoc()).getSpellingLineNumber()) +
+                            ": collapse " + to_string(collapse) + ", trip counts";
+        for (int i = 0, ie = tripCounts.size(); i != ie; i++)
+          shape += " " + tripCounts[i];
+        shape += ", iterations " + (iterationsKnown ? to_string(collapsedIterations) : std::string("unknown"));
+        loopShapes.insert(loopShapes.begin(), shape);
+      }
+      info += ",\n\"collapse\":\"" + to_string(collapse) + "\"";
+      info += ",\n\"perfectly nested loops\":\"" + to_string(nest.size()) + "\"";
+      info += ",\n\"level trip counts\":[" + joinJsonList(tripCounts) + "]";
+      info += ",\n\"collapsed iterations\":\"" + (iterationsKnown ? to_string(collapsedIterations) : std::string("unknown")) + "\"";
+      info += ",\n\"loop directives\":[" + joinJsonList(loopShapes) + "]";
+
+      /*conditionals of the innermost level*/
+      if (nest.empty())
+        return info;
+      Stmt *innermost = nest.back();
+      LoopBounds bounds;
+      VarDecl *var = getLoopBounds(innermost, bounds) ? bounds.inductionVar : nullptr;
+      set<VarDecl*> written, innerInductionVars;
+      collectWrittenVars(getLoopBody(innermost), written, innerInductionVars);
+      /*conditions on the iteration or on loaded data take different paths per thread*/
+      for (int k = 0, ke = nest.size(); k != ke; k++) {
+        LoopBounds levelBounds;
+        if (getLoopBounds(nest[k], levelBounds))
+          written.insert(levelBounds.inductionVar);
+      }
+      unsigned int conditionals = 0, divergent = 0;
+      vector<Stmt*> body_nodes;
+      visitNodes(getLoopBody(innermost), body_nodes);
+      for (int i = 0, ie = body_nodes.size(); i != ie; i++) {
+        Expr *cond = nullptr;
+        if (IfStmt *ifst = dyn_cast<IfStmt>(body_nodes[i]))
+          cond = ifst->getCond();
+        else if (SwitchStmt *swst = dyn_cast<SwitchStmt>(body_nodes[i]))
+          cond = swst->getCond();
+        else if (ConditionalOperator *CO = dyn_cast<ConditionalOperator>(body_nodes[i]))
+          cond = CO->getCond();
+        if (!cond)
+          continue;
+        conditionals++;
+        if (dependsOnVars(cond, var, written) || hasDependentLoad(cond, var, written))
+          divergent++;
+      }
+      info += ",\n\"innermost conditionals\":\"" + to_string(conditionals) + "\"";
+      info += ",\n\"divergent conditionals\":\"" + to_string(divergent) + "\"";
+      return info;
+    }
+
+    /*target enter/exit data directives of a function body, in source order, with the
+     * list items they map*/
+    void collectDataDirectives(Stmt *body, vector<pair<OMPExecutableDirective*, MappedData> > & events) {
+      vector<Stmt*> nodes_list;
+      visitNodes(body, nodes_list);
+      for (int i = 0, ie = nodes_list.size(); i != ie; i++) {
+        if (!isa<OMPTargetEnterDataDirective>(nodes_list[i]) && !isa<OMPTargetExitDataDirective>(nodes_list[i]))
+          continue;
+        OMPExecutableDirective *OMPED = cast<OMPExecutableDirective>(nodes_list[i]);
+        vector<MappedData> mapped;
+        collectMappedData(OMPED, mapped);
+        for (int k = 0, ke = mapped.size(); k != ke; k++)
+          if (mapped[k].decl)
+            events.push_back(make_pair(OMPED, mapped[k]));
+      }
+    }
+
+    /*target enter or exit data directive mapping a variable in the functions of a
+     * declaration context other than the given one, walking nested namespaces, classes
+     * and templates*/
+    FunctionDecl *findDataDirectiveInContext(DeclContext *DC, FunctionDecl *FD, ValueDecl *decl, bool enter, unsigned int & line) {
+      for (auto I = DC->decls_begin(), IE = DC->decls_end(); I != IE; I++) {
+        Decl *D = *I;
+        if (FunctionTemplateDecl *FTD = dyn_cast<FunctionTemplateDecl>(D))
+          D = FTD->getTemplatedDecl();
+        if (FunctionDecl *other = dyn_cast<FunctionDecl>(D)) {
+          if (other == FD || !other->doesThisDeclarationHaveABody())
+            continue;
+          vector<pair<OMPExecutableDirective*, MappedData> > events;
+          collectDataDirectives(other->getBody(), events);
+          for (int i = 0, ie = events.size(); i != ie; i++) {
+            if (events[i].second.decl == decl && isa<OMPTargetEnterDataDirective>(events[i].first) == enter) {
+              line = astContext->getFullLoc(events[i].first->getBeginLoc()).getSpellingLineNumber();
+              return other;
+            }
+          }
+          continue;
+        }
+        if (DeclContext *inner = dyn_cast<DeclContext>(D))
+          if (FunctionDecl *other = findDataDirectiveInContext(inner, FD, decl, enter, line))
+            return other;
+      }
+      return nullptr;
+    }
+
+    /*target enter or exit data directive of another function of the translation unit
+     * mapping a global variable, if any*/
+    FunctionDecl *findDataDirectiveElsewhere(FunctionDecl *FD, ValueDecl *decl, bool enter, unsigned int & line) {
+      VarDecl *VD = dyn_cast<VarDecl>(decl);
+      if (!VD || !VD->hasGlobalStorage())
+        return nullptr;
+      return findDataDirectiveInContext(astContext->getTranslationUnitDecl(), FD, decl, enter, line);
+    }
+
+    /*creates records for the device lifetime of the variables mapped by target enter and
+     * exit data directives of a function: enters are paired with the exits of the same
+     * variable (release pops one reference, delete all of them). Enters left unmatched
+     * leak device memory and exits without enters are flagged, unless a function of the
+     * translation unit holds the other half for the global variable. Pairs whose directives are in
+     * different loops leave the reference count unbalanced*/
+    void insertDataLifetimeNodes(FunctionDecl *FD) {
+      vector<pair<OMPExecutableDirective*, MappedData> > events;
+      collectDataDirectives(FD->getBody(), events);
+      if (events.empty())
+        return;
+
+      vector<Stmt*> nodes_list;
+      visitNodes(FD->getBody(), nodes_list);
+      map<ValueDecl*, vector<OMPExecutableDirective*> > open;
+      vector<ValueDecl*> order;
+      for (int i = 0, ie = events.size(); i != ie; i++) {
+        OMPExecutableDirective *OMPED = events[i].first;
+        MappedData & data = events[i].second;
+        std::string fields = ",\n\"variable\":\"" + exprToString(data.expr) + "\"";
+        unsigned int line = astContext->getFullLoc(OMPED->getBeginLoc()).getSpellingLineNumber();
+        if (isa<OMPTargetEnterDataDirective>(OMPED)) {
+          if (open.count(data.decl) == 0)
+            order.push_back(data.decl);
+          open[data.decl].push_back(OMPED);
+          continue;
+        }
+
+        /*an exit closes the last enter, or all of them with delete*/
+        if (open[data.decl].empty()) {
+          unsigned int otherLine = 0;
+          FunctionDecl *other = findDataDirectiveElsewhere(FD, data.decl, true, otherLine);
+          if (other) {
+            fields += ",\n\"enter function\":\"" + other->getNameAsString() + "\"";
+            fields += ",\n\"enter line\":\"" + to_string(otherLine) + "\"";
+          }
+          fields += ",\n\"exit line\":\"" + to_string(line) + "\"";
+          fields += ",\n\"status\":\"" + std::string(other ? "paired across functions" : "exit without enter") + "\"";
+          insertRegionNode(OMPED, "target data lifetime", fields);
+          continue;
+        }
+        vector<OMPExecutableDirective*> closed;
+        if (data.mapType == OMPC_MAP_delete) {
+          closed = open[data.decl];
+          open[data.decl].clear();
+        }
+        else {
+          closed.push_back(open[data.decl].back());
+          open[data.decl].pop_back();
+        }
+        for (int k = 0, ke = closed.size(); k != ke; k++) {
+          unsigned int enterLine = astContext->getFullLoc(closed[k]->getBeginLoc()).getSpellingLineNumber();
+          vector<Stmt*> enterLoops, exitLoops;
+          getSequentialLoopsAround(closed[k], enterLoops);
+          getSequentialLoopsAround(OMPED, exitLoops);
+          unsigned int targets = 0;
+          for (int j = 0, je = nodes_list.size(); j != je; j++) {
+            unsigned int targetLine = astContext->getFullLoc(nodes_list[j]->getBeginLoc()).getSpellingLineNumber();
+            if (isMappingTarget(nodes_list[j]) && targetLine > enterLine && targetLine < line)
+              targets++;
+          }
+          std::string pairFields = fields;
+          pairFields += ",\n\"enter line\":\"" + to_string(enterLine) + "\"";
+          pairFields += ",\n\"exit line\":\"" + to_string(line) + "\"";
+          pairFields += ",\n\"exit map type\":\"" + getMapTypeName(data.mapType) + "\"";
+          pairFields += ",\n\"lifetime lines\":\"" + to_string(line - enterLine) + "\"";
+          pairFields += ",\n\"target regions in lifetime\":\"" + to_string(targets) + "\"";
+          pairFields += ",\n\"status\":\"" + std::string((enterLoops == exitLoops) ? "paired" : "different loop nesting") + "\"";
+          insertRegionNode(closed[k], "target data lifetime", pairFields);
+        }
+      }
+
+      /*enters still open at the end of the function*/
+      for (int i = 0, ie = order.size(); i != ie; i++) {
+        ValueDecl *decl = order[i];
+        for (int k = 0, ke = open[decl].size(); k != ke; k++) {
+          unsigned int otherLine = 0;
+          FunctionDecl *other = findDataDirectiveElsewhere(FD, decl, false, otherLine);
+          std::string fields = ",\n\"variable\":\"" + decl->getNameAsString() + "\"";
+          fields += ",\n\"enter line\":\"" + to_string(astContext->getFullLoc(open[decl][k]->getBeginLoc()).getSpellingLineNumber()) + "\"";
+          if (other) {
+            fields += ",\n\"exit function\":\"" + other->getNameAsString() + "\"";
+            fields += ",\n\"exit line\":\"" + to_string(otherLine) + "\"";
+            fields += ",\n\"status\":\"paired across functions\"";
+          }
+          else
+            fields += ",\n\"status\":\"unmatched enter\"";
+          insertRegionNode(open[decl][k], "target data lifetime", fields);
+        }
+      }
+    }
+
+    /*Json fields with the readiness of a simd or for loop for vectorization: a score out
+     * of 100 with the reasons blocking it (calls without declare simd, carried dependences,
+     * early exits) and the ones that make the vector code slower (non unit strides,
+     * indirect accesses, type conversions, conditionals and inner loops)*/
+    std::string getVectorizationInfo(Stmt *st, DependenceInfo & info) {
+      OMPExecutableDirective *OMPED = getLoopDirective(st);
+      if (!OMPED || !isOpenMPLoopDirective(OMPED->getDirectiveKind()) ||
+          (!isOpenMPSimdDirective(OMPED->getDirectiveKind()) && !isOpenMPWorksharingDirective(OMPED->getDirectiveKind())))
+        return std::string();
+      LoopBounds bounds;
+      if (!getLoopBounds(st, bounds))
+        return ",\n\"vectorization score\":\"0\",\n\"vectorization blockers\":[\"non canonical loop\"]";
+      Stmt *body = getLoopBody(st);
+      VarDecl *var = bounds.inductionVar;
+      vector<std::string> blockers, penalties;
+      int score = 100;
+
+      /*dependences, with the calls checked below*/
+      for (int i = 0, ie = info.blocking.size(); i != ie; i++) {
+        StringRef reason(info.blocking[i]);
+        if (!reason.startswith("call to ") && !reason.startswith("indirect call "))
+          blockers.push_back(info.blocking[i]);
+      }
+
+      int conversions = 0, conditionals = 0, innerLoops = 0;
+      vector<Stmt*> nodes_list;
+      visitNodes(body, nodes_list);
+      for (int i = 0, ie = nodes_list.size(); i != ie; i++) {
+        Stmt *node = nodes_list[i];
+        std::string where = " at line " + to_string(astContext->getFullLoc(node->getBeginLoc()).getSpellingLineNumber());
+        if (CallExpr *CE = dyn_cast<CallExpr>(node)) {
+          FunctionDecl *FD = CE->getDirectCallee();
+          if (!FD)
+            blockers.push_back("indirect call" + where);
+          else if (!isKnownMathFunction(FD) && !FD->hasAttr<OMPDeclareSimdDeclAttr>())
+            blockers.push_back("call to " + FD->getNameAsString() + " without declare simd" + where);
+        }
+        else if (CastExpr *CEx = dyn_cast<CastExpr>(node)) {
+          CastKind kind = CEx->getCastKind();
+          if (kind == CK_IntegralToFloating || kind == CK_FloatingToIntegral || kind == CK_FloatingCast)
+            conversions++;
+        }
+        else if (isa<IfStmt>(node) || isa<SwitchStmt>(node) || isa<ConditionalOperator>(node)) {
+          conditionals++;
+          penalties.push_back("conditional" + where);
+        }
+        else if (isa<DoStmt>(node) || isa<ForStmt>(node) || isa<WhileStmt>(node)) {
+          innerLoops++;
+          penalties.push_back("inner loop" + where);
+        }
+      }
+      if (conversions > 0)
+        penalties.push_back(to_string(conversions) + " type conversions");
+
+      set<VarDecl*> written, innerInductionVars;
+      vector<MemAccess> accesses;
+      collectWrittenVars(body, written, innerInductionVars);
+      written.erase(var);
+      collectMemAccesses(body, true, false, accesses);
+      int strided = 0, indirect = 0;
+      for (int i = 0, ie = accesses.size(); i != ie; i++) {
+        classifyAccess(accesses[i], var, written);
+        if (accesses[i].pattern == "constant stride" || accesses[i].pattern == "unknown") {
+          strided++;
+          penalties.push_back("non unit stride " + exprToString(accesses[i].expr));
+        }
+        else if (accesses[i].pattern == "indirect") {
+          indirect++;
+          penalties.push_back("indirect access " + exprToString(accesses[i].expr));
+        }
+      }
+
+      score -= 25 * (int) blockers.size() + 10 * strided + 15 * indirect + 10 * innerLoops;
+      score -= std::min(20, 5 * conversions) + std::min(30, 10 * conditionals);
+      score = std::max(0, score);
+
+      std::string fields = ",\n\"vectorization score\":\"" + to_string(score) + "\"";
+      if (blockers.size() > 0)
+        fields += ",\n\"vectorization blockers\":[" + joinJsonList(blockers) + "]";
+      if (penalties.size() > 0)
+        fields += ",\n\"vectorization penalties\":[" + joinJsonList(penalties) + "]";
+      return fields;
+    }
+
+    /*check if an expression allocates fresh memory (malloc, calloc, aligned_alloc, new)*/
+    bool isAllocation(Expr *ex) {
+      ex = ex->IgnoreParenCasts();
+      if (isa<CXXNewExpr>(ex))
+        return true;
+      CallExpr *CE = dyn_cast<CallExpr>(ex);
+      if (!CE || !CE->getDirectCallee())
+        return false;
+      std::string name = CE->getDirectCallee()->getNameAsString();
+      return name == "malloc" || name == "calloc" || name == "aligned_alloc" ||
+             name == "_mm_malloc" || name == "omp_alloc";
+    }
+
+    /*pointers of a function that only hold fresh allocations: every initialization and
+     * assignment of them in the function is an allocation*/
+    void collectAllocatedPointers(Stmt *st, map<VarDecl*, unsigned int> & allocated) {
+      set<VarDecl*> other;
+      vector<Stmt*> nodes_list;
+      visitNodes(st, nodes_list);
+      for (int i = 0, ie = nodes_list.size(); i != ie; i++) {
+        VarDecl *VD = nullptr;
+        Expr *value = nullptr;
+        if (DeclStmt *DCst = dyn_cast<DeclStmt>(nodes_list[i])) {
+          for (auto I = DCst->decl_begin(), IE = DCst->decl_end(); I != IE; I++) {
+            VarDecl *declared = dyn_cast<VarDecl>(*I);
+            if (declared && declared->getType()->isPointerType() && declared->getInit()) {
+              if (isAllocation(declared->getInit()))
+                allocated[declared] = astContext->getFullLoc(declared->getBeginLoc()).getSpellingLineNumber();
+              else
+                other.insert(declared);
+            }
+          }
+          continue;
+        }
+        if (BinaryOperator *biop = dyn_cast<BinaryOperator>(nodes_list[i])) {
+          if (biop->getOpcode() == BO_Assign) {
+            VD = getReferencedVar(biop->getLHS());
+            value = biop->getRHS();
+          }
+        }
+        /*posix_memalign(&p, alignment, size)*/
+        if (CallExpr *CE = dyn_cast<CallExpr>(nodes_list[i])) {
+          UnaryOperator *addr = nullptr;
+          if (CE->getDirectCallee() && CE->getDirectCallee()->getNameAsString() == "posix_memalign" && CE->getNumArgs() > 0)
+            addr = dyn_cast<UnaryOperator>(CE->getArg(0)->IgnoreParenCasts());
+          if (addr && addr->getOpcode() == UO_AddrOf && (VD = getReferencedVar(addr->getSubExpr())) && VD->getType()->isPointerType())
+            allocated[VD] = astContext->getFullLoc(CE->getBeginLoc()).getSpellingLineNumber();
+          continue;
+        }
+        if (!VD || !VD->getType()->isPointerType())
+          continue;
+        if (isAllocation(value))
+          allocated[VD] = astContext->getFullLoc(nodes_list[i]->getBeginLoc()).getSpellingLineNumber();
+        else
+          other.insert(VD);
+      }
+      for (set<VarDecl*>::iterator I = other.begin(), IE = other.end(); I != IE; I++)
+        allocated.erase(*I);
+    }
+
+    /*variables whose address is copied into another pointer of a function, in the
+     * initialization or the assignment of that pointer (p = a + 1, q = r)*/
+    void collectEscapedStorage(Stmt *st, set<VarDecl*> & escaped) {
+      vector<Stmt*> nodes_list;
+      visitNodes(st, nodes_list);
+      for (int i = 0, ie = nodes_list.size(); i != ie; i++) {
+        VarDecl *target = nullptr;
+        Expr *value = nullptr;
+        if (DeclStmt *DCst = dyn_cast<DeclStmt>(nodes_list[i])) {
+          for (auto I = DCst->decl_begin(), IE = DCst->decl_end(); I != IE; I++) {
+            VarDecl *declared = dyn_cast<VarDecl>(*I);
+            if (!declared || !declared->getType()->isPointerType() || !declared->getInit())
+              continue;
+            vector<Stmt*> refs;
+            visitNodes(declared->getInit(), refs);
+            for (int k = 0, ke = refs.size(); k != ke; k++)
+              if (DeclRefExpr *DRex = dyn_cast<DeclRefExpr>(refs[k]))
+                if (VarDecl *VD = dyn_cast<VarDecl>(DRex->getDecl()))
+                  if (VD != declared)
+                    escaped.insert(VD);
+          }
+          continue;
+        }
+        BinaryOperator *biop = dyn_cast<BinaryOperator>(nodes_list[i]);
+        if (!biop || biop->getOpcode() != BO_Assign || !biop->getLHS()->getType()->isPointerType())
+          continue;
+        target = getReferencedVar(biop->getLHS());
+        value = biop->getRHS();
+        vector<Stmt*> refs;
+        visitNodes(value, refs);
+        for (int k = 0, ke = refs.size(); k != ke; k++)
+          if (DeclRefExpr *DRex = dyn_cast<DeclRefExpr>(refs[k]))
+            if (VarDecl *VD = dyn_cast<VarDecl>(DRex->getDecl()))
+              if (VD != target)
+                escaped.insert(VD);
+      }
+    }
+
+    /*check if a base kind names storage only reachable through its own variable*/
+    bool isFreshStorage(std::string kind) {
+      return kind == "local array" || kind.compare(0, 9, "allocated") == 0;
+    }
+
+    /*Json fields with the pointer aliasing of a loop: the bases it accesses and what is
+     * known of them (restrict, local array, fresh allocation, parameter), the pairs that
+     * may overlap with at least one of them written, and whether restrict or simd would
+     * be justified (the loop is parallel once the pointers don't alias)*/
+    std::string getAliasingInfo(Stmt *st, DependenceInfo & info) {
+      Stmt *body = getLoopBody(st);
+      if (!body)
+        return std::string();
+      vector<Stmt*> enclosing;
+      getEnclosingStmts(st, enclosing);
+      map<VarDecl*, unsigned int> allocated;
+      set<VarDecl*> escaped;
+      collectAllocatedPointers(enclosing.empty() ? st : enclosing.back(), allocated);
+      collectEscapedStorage(enclosing.empty() ? st : enclosing.back(), escaped);
+
+      vector<MemAccess> accesses;
+      collectMemAccesses(body, true, false, accesses);
+      vector<ValueDecl*> bases;
+      set<ValueDecl*> writtenBases;
+      for (int i = 0, ie = accesses.size(); i != ie; i++) {
+        ValueDecl *base = accesses[i].base;
+        if (!base || (!base->getType()->isPointerType() && !base->getType()->isArrayType()))
+          continue;
+        if (std::find(bases.begin(), bases.end(), base) == bases.end())
+          bases.push_back(base);
+        if (accesses[i].isWrite)
+          writtenBases.insert(base);
+      }
+
+      /*what is known of each base*/
+      vector<std::string> kinds, descriptions;
+      bool pointers = false;
+      for (int i = 0, ie = bases.size(); i != ie; i++) {
+        ValueDecl *base = bases[i];
+        VarDecl *VD = dyn_cast<VarDecl>(base);
+        std::string kind = "unknown";
+        if (base->getType().isRestrictQualified())
+          kind = "restrict";
+        else if (base->getType()->isArrayType() && VD && !isa<ParmVarDecl>(VD))
+          kind = VD->hasGlobalStorage() ? "global array" : "local array";
+        else if (VD && allocated.count(VD) != 0)
+          kind = "allocated at line " + to_string(allocated[VD]);
+        else if (VD && isa<ParmVarDecl>(VD))
+          kind = "parameter";
+        else if (isa<FieldDecl>(base))
+          kind = "field";
+        pointers |= base->getType()->isPointerType();
+        kinds.push_back(kind);
+        descriptions.push_back(base->getNameAsString() + " (" + kind + ")");
+      }
+      if (!pointers)
+        return std::string();
+
+      /*pairs that can't be proven distinct*/
+      vector<std::string> mayAlias;
+      bool parametersOnly = true;
+      for (int i = 0, ie = bases.size(); i != ie; i++) {
+        for (int j = i + 1; j != ie; j++) {
+          if (writtenBases.count(bases[i]) == 0 && writtenBases.count(bases[j]) == 0)
+            continue;
+          /*restrict promises no overlap, two fresh allocations or local arrays are
+           * distinct, one of them can't be reached through another base unless its
+           * address was copied into some pointer, and two arrays never overlap*/
+          VarDecl *first = dyn_cast<VarDecl>(bases[i]), *second = dyn_cast<VarDecl>(bases[j]);
+          bool fresh = (isFreshStorage(kinds[i]) && isFreshStorage(kinds[j])) ||
+                       (isFreshStorage(kinds[i]) && escaped.count(first) == 0) ||
+                       (isFreshStorage(kinds[j]) && escaped.count(second) == 0);
+          bool arrays = kinds[i].find("array") != std::string::npos && kinds[j].find("array") != std::string::npos;
+          if (kinds[i] == "restrict" || kinds[j] == "restrict" || fresh || arrays)
+            continue;
+          mayAlias.push_back(bases[i]->getNameAsString() + ", " + bases[j]->getNameAsString());
+          parametersOnly &= (kinds[i] == "parameter" || kinds[i] == "global array") &&
+                            (kinds[j] == "parameter" || kinds[j] == "global array");
+        }
+      }
+
+      std::string fields = ",\n\"pointer bases\":[" + joinJsonList(descriptions) + "]";
+      if (mayAlias.size() > 0)
+        fields += ",\n\"may alias pairs\":[" + joinJsonList(mayAlias) + "]";
+      bool parallelWithoutAliasing = (info.verdict != "dependent") && info.assumesNoAlias;
+      fields += ",\n\"restrict recommended\":\"" + std::string((mayAlias.size() > 0 && parametersOnly) ? "true" : "false") + "\"";
+      fields += ",\n\"simd recommended\":\"" + std::string((mayAlias.size() > 0 && parallelWithoutAliasing) ? "true" : "false") + "\"";
+      return fields;
+    }
+
+    /*check if a statement is a target construct that moves data with map clauses*/
+    bool isMappingTarget(Stmt *st) {
+      OMPExecutableDirective *OMPED = dyn_cast<OMPExecutableDirective>(st);
+      return OMPED && isTargetDirective(OMPED) && !isa<OMPTargetUpdateDirective>(OMPED);
+    }
+
+    /*check if host code in a statement may access a variable: references outside target
+     * constructs, or calls to functions when the variable is global*/
+    bool hostAccesses(Stmt *st, ValueDecl *decl) {
+      VarDecl *VD = dyn_cast<VarDecl>(decl);
+      vector<Stmt*> nodes_list;
+      visitNodes(st, nodes_list);
+      for (int i = 0, ie = nodes_list.size(); i != ie; i++) {
+        Stmt *node = nodes_list[i];
+        bool access = false;
+        if (DeclRefExpr *DRex = dyn_cast<DeclRefExpr>(node))
+          access = (DRex->getDecl() == decl);
+        else if (MemberExpr *MEx = dyn_cast<MemberExpr>(node))
+          access = (MEx->getMemberDecl() == decl);
+        else if (CallExpr *CE = dyn_cast<CallExpr>(node))
+          access = VD && VD->hasGlobalStorage() && (!CE->getDirectCallee() || !isKnownMathFunction(CE->getDirectCallee()));
+        if (!access)
+          continue;
+        /*accesses inside target constructs are done on the device*/
+        bool onDevice = isMappingTarget(node);
+        vector<Stmt*> enclosing;
+        getEnclosingStmts(node, enclosing);
+        for (int k = 0, ke = enclosing.size(); k != ke && enclosing[k] != st && !onDevice; k++)
+          onDevice = isMappingTarget(enclosing[k]);
+        if (!onDevice)
+          return true;
+      }
+      return false;
+    }
+
+    /*transfer of a variable in a list of transfers, if any*/
+    MappedData *findTransfer(vector<MappedData> & transfers, ValueDecl *decl) {
+      for (int i = 0, ie = transfers.size(); i != ie; i++)
+        if (transfers[i].decl == decl)
+          return &transfers[i];
+      return nullptr;
+    }
+
+    /*data moved by a target construct, without the variables present from target data,
+     * in the order of its map clauses (the last item of a variable wins)*/
+    void collectTransfers(OMPExecutableDirective *OMPED, vector<MappedData> & transfers) {
+      vector<MappedData> mapped;
+      collectMappedData(OMPED, mapped);
+      for (int i = 0, ie = mapped.size(); i != ie; i++) {
+        if (!mapped[i].decl || getEnclosingTargetData(OMPED, mapped[i].decl))
+          continue;
+        if (mapped[i].mapType != OMPC_MAP_to && mapped[i].mapType != OMPC_MAP_from && mapped[i].mapType != OMPC_MAP_tofrom)
+          continue;
+        if (MappedData *previous = findTransfer(transfers, mapped[i].decl))
+          *previous = mapped[i];
+        else
+          transfers.push_back(mapped[i]);
+      }
+    }
+
+    /*entry of a variable in the list of redundant transfers, added at the end when new*/
+    RedundantTransfer & getRedundantEntry(vector<RedundantTransfer> & redundant, ValueDecl *decl) {
+      for (int i = 0, ie = redundant.size(); i != ie; i++)
+        if (redundant[i].decl == decl)
+          return redundant[i];
+      RedundantTransfer entry;
+      entry.decl = decl;
+      entry.to = false;
+      entry.from = false;
+      redundant.push_back(entry);
+      return redundant.back();
+    }
+
+    /*recommended data region for variables moved again and again: a target data region
+     * and the equivalent target enter/exit data pair*/
+    std::string getDataRegionRecommendation(vector<RedundantTransfer> & redundant, std::string where) {
+      vector<std::string> tofrom, to, from, alloc;
+      for (int i = 0, ie = redundant.size(); i != ie; i++) {
+        if (redundant[i].to && redundant[i].from)
+          tofrom.push_back(redundant[i].expr);
+        else if (redundant[i].to)
+          to.push_back(redundant[i].expr);
+        else if (redundant[i].from)
+          from.push_back(redundant[i].expr);
+        else
+          alloc.push_back(redundant[i].expr);
+      }
+      std::string dataRegion = "target data";
+      std::string enter = "target enter data";
+      std::string exit = "target exit data";
+      vector<std::string> *lists[] = {&tofrom, &to, &from, &alloc};
+      const char *names[] = {"tofrom", "to", "from", "alloc"};
+      for (int i = 0; i != 4; i++) {
+        if (lists[i]->empty())
+          continue;
+        std::string items = lists[i]->at(0);
+        for (int k = 1, ke = lists[i]->size(); k != ke; k++)
+          items += ", " + lists[i]->at(k);
+        dataRegion += " map(" + std::string(names[i]) + ": " + items + ")";
+        enter += " map(" + std::string((i == 0 || i == 1) ? "to" : "alloc") + ": " + items + ")";
+        exit += " map(" + std::string((i == 0 || i == 2) ? "from" : "release") + ": " + items + ")";
+      }
+      vector<std::string> recommendations;
+      recommendations.push_back(dataRegion + " " + where);
+      recommendations.push_back(enter + " before and " + exit + " after, " + where);
+      return ",\n\"recommendations\":[" + joinJsonList(recommendations) + "]";
+    }
+
+    /*creates records for the data moved again and again between host and device in a
+     * function: sequences of target constructs of a block mapping the same variables
+     * without host accesses between them, and target constructs inside sequential loops
+     * whose data isn't accessed by the host in the loop*/
+    void insertTransferNodes(FunctionDecl *FD) {
+      vector<Stmt*> nodes_list;
+      visitNodes(FD->getBody(), nodes_list);
+      for (int i = 0, ie = nodes_list.size(); i != ie; i++) {
+        /*sequences of target constructs in a block*/
+        if (CompoundStmt *CS = dyn_cast<CompoundStmt>(nodes_list[i])) {
+          vector<Stmt*> children(CS->body_begin(), CS->body_end());
+          vector<Stmt*> sequence;
+          vector<RedundantTransfer> redundant;
+          int previous = -1;
+          for (int k = 0, ke = children.size(); k <= ke; k++) {
+            bool extended = false;
+            if (k != ke && isMappingTarget(children[k]) && previous >= 0) {
+              vector<MappedData> before, after;
+              collectTransfers(cast<OMPExecutableDirective>(children[previous]), before);
+              collectTransfers(cast<OMPExecutableDirective>(children[k]), after);
+              for (int m = 0, me = after.size(); m != me; m++) {
+                MappedData *first = findTransfer(before, after[m].decl);
+                if (!first)
+                  continue;
+                bool hostAccess = false;
+                for (int j = previous + 1; j != k && !hostAccess; j++)
+                  hostAccess = hostAccesses(children[j], after[m].decl);
+                if (hostAccess)
+                  continue;
+                RedundantTransfer & entry = getRedundantEntry(redundant, after[m].decl);
+                if (entry.expr.empty()) {
+                  entry.expr = exprToString(first->expr);
+                  entry.to = (first->mapType != OMPC_MAP_from);
+                }
+                entry.from = (after[m].mapType != OMPC_MAP_to);
+                extended = true;
+              }
+            }
+            if (extended) {
+              if (sequence.empty())
+                sequence.push_back(children[previous]);
+              sequence.push_back(children[k]);
+            }
+            else if (k == ke || isMappingTarget(children[k])) {
+              /*the sequence ends, report it*/
+              if (sequence.size() > 1) {
+                vector<std::string> targets, data;
+                for (int j = 0, je = sequence.size(); j != je; j++)
+                  targets.push_back("target at line " + to_string(astContext->getFullLoc(sequence[j]->getBeginLoc()).getSpellingLineNumber()));
+                for (int j = 0, je = redundant.size(); j != je; j++)
+                  data.push_back(redundant[j].expr);
+                std::string where = "around lines " + to_string(astContext->getFullLoc(sequence.front()->getBeginLoc()).getSpellingLineNumber()) +
+                                    "-" + to_string(astContext->getFullLoc(sequence.back()->getEndLoc()).getSpellingLineNumber());
+                std::string fields = ",\n\"targets\":[" + joinJsonList(targets) + "]";
+                fields += ",\n\"redundant data\":[" + joinJsonList(data) + "]";
+                fields += getDataRegionRecommendation(redundant, where);
+                insertRegionNode(sequence.front(), "redundant transfers", fields);
+              }
+              sequence.clear();
+              redundant.clear();
+            }
+            if (k != ke && isMappingTarget(children[k]))
+              previous = k;
+          }
+        }
+
+        /*target constructs repeated by a sequential loop*/
+        if (isMappingTarget(nodes_list[i])) {
+          vector<Stmt*> loops;
+          getSequentialLoopsAround(nodes_list[i], loops);
+          if (loops.empty())
+            continue;
+          vector<MappedData> transfers;
+          collectTransfers(cast<OMPExecutableDirective>(nodes_list[i]), transfers);
+          vector<RedundantTransfer> redundant;
+          vector<std::string> data;
+          for (int m = 0, me = transfers.size(); m != me; m++) {
+            if (hostAccesses(loops[0], transfers[m].decl))
+              continue;
+            RedundantTransfer & entry = getRedundantEntry(redundant, transfers[m].decl);
+            entry.expr = exprToString(transfers[m].expr);
+            entry.to = (transfers[m].mapType != OMPC_MAP_from);
+            entry.from = (transfers[m].mapType != OMPC_MAP_to);
+            data.push_back(exprToString(transfers[m].expr));
+          }
+          if (data.empty())
+            continue;
+          LoopBounds bounds;
+          unsigned int line = astContext->getFullLoc(loops[0]->getBeginLoc()).getSpellingLineNumber();
+          std::string fields = ",\n\"enclosing sequential loop\":\"" + to_string(line) + "\"";
+          fields += ",\n\"enclosing loop trip count\":\"" + (getLoopBounds(loops[0], bounds) ? bounds.tripCount : std::string("unknown")) + "\"";
+          fields += ",\n\"redundant data\":[" + joinJsonList(data) + "]";
+          fields += getDataRegionRecommendation(redundant, "around the loop at line " + to_string(line));
+          insertRegionNode(nodes_list[i], "redundant transfers", fields);
+        }
+      }
+    }
+
+    /*associate the information of some node in the AST to it's sub tree. Important to normalize
+     * standart information on each loop.*/
+    void associateEachLoopInside(OMPExecutableDirective *OMPED, map<string, string> & clauses) {
+      struct InputFile& currFile = FileStack.top();
+      vector<Stmt*> nodes_list;
+      visitNodes(OMPED, nodes_list);
+      llvm::outs() << "associateEachLoopInside vector size: " << nodes_list.size() << "\n";
+      statList(nodes_list);
+
+      if (currFile.visited.count(OMPED) != 0)
+	return;
+      currFile.visited[OMPED] = true;
+
+      if (isTargetDirective(OMPED))
+        clauses["offload"] = "true";
+
+      if (isa<OMPParallelDirective>(OMPED)) 
+        clauses["parallel"] = "true";
+
+      /*parallel regions get their own record with the analyses of the region*/
+      if (isa<OMPParallelDirective>(OMPED)) {
+        std::string regionInfo = std::string();
+        map<string, string> regionClauses;
+        for (int i = 0, ie = OMPED->getNumClauses(); i != ie; i++)
+          ClassifyClause(OMPED->getClause(i), regionClauses);
+        std::string falseSharing = getFalseSharingInfo(OMPED, regionClauses);
+        if (falseSharing.find("\"false sharing list\"") != std::string::npos)
+          regionInfo += falseSharing;
+        regionInfo += getHoistingInfo(OMPED);
+        regionInfo += getBarrierInfo(OMPED);
+        regionInfo += getNestingInfo(OMPED);
+        if (!regionInfo.empty())
+          insertRegionNode(OMPED, "parallel", regionInfo);
+      }
+
+      /*target regions that aren't loops get their own record with the data they move*/
+      if (isTargetDirective(OMPED) && !isa<OMPLoopDirective>(OMPED) && !isa<OMPTargetUpdateDirective>(OMPED))
+        insertRegionNode(OMPED, "target", getOffloadVolumeInfo(OMPED, nullptr) + getMapNarrowingInfo(OMPED) +
+                                          getKernelShapeInfo(OMPED));
+
+      if (isa<OMPOrderedDirective>(OMPED)) {
+	  const SourceManager& mng = astContext->getSourceManager();
+	  std::string snippet = std::string();
+	  if (ClDCSnippet == true)
+	    snippet = getSourceSnippet(OMPED->getInnermostCapturedStmt()->getSourceRange(), true, true);
+/*
+        llvm::raw_string_ostream outstream(snippet);
+        //body->printPretty(outstream, NULL, PrintingPolicy(lo));
+        OMPED->getInnermostCapturedStmt()->dump(outstream, *astContext);
+        //errs() << "loop body: " << snippet << "\n"; 
+*/
+	  vector<Stmt*> protectedStmts;
+	  if (OMPED->hasAssociatedStmt())
+	    protectedStmts.push_back(OMPED->getInnermostCapturedStmt()->getCapturedStmt());
+	  insertStmtDirectives(OMPED, "ordered", snippet, getContentionInfo(OMPED, "ordered", protectedStmts), clauses);
+      }
+
+      if (OMPCriticalDirective *OMPCD = dyn_cast<OMPCriticalDirective>(OMPED)) {
+	std::string snippet = std::string();
+	if (ClDCSnippet == true)
+          snippet = getSourceSnippet(OMPCD->getInnermostCapturedStmt()->getSourceRange(), true, true);
+	std::string fields = std::string();
+	std::string name = OMPCD->getDirectiveName().getAsString();
+	if (!name.empty())
+	  fields += ",\n\"critical name\":\"" + name + "\"";
+	vector<Stmt*> protectedStmts(1, OMPCD->getInnermostCapturedStmt()->getCapturedStmt());
+	fields += getContentionInfo(OMPCD, "critical", protectedStmts);
+	insertStmtDirectives(OMPCD, "critical", snippet, fields, clauses);
+      }
+
+      if (OMPAtomicDirective * OMPAD = dyn_cast<OMPAtomicDirective>(OMPED)) {
+
+	std::string snippet = std::string();
+	if (ClDCSnippet == true)
+          snippet = getSourceSnippet(OMPAD->getInnermostCapturedStmt()->getSourceRange(), true, true);
+/*
+        llvm::raw_string_ostream outstream(snippet);
+        //body->printPretty(outstream, NULL, PrintingPolicy(lo));
+        OMPAD->getInnermostCapturedStmt()->dump(outstream, *astContext);
+*/
+        vector<Stmt*> protectedStmts(1, OMPAD->getInnermostCapturedStmt()->getCapturedStmt());
+        std::string fields = getContentionInfo(OMPAD, "atomic", protectedStmts);
+        if (OMPAD->getNumClauses() > 0) {
+	  if (isa<OMPCaptureClause>(OMPED->getClause(0)))
+            insertStmtDirectives(OMPAD, "atomic capture", snippet, fields, clauses);
+	  else if (isa<OMPWriteClause>(OMPED->getClause(0)))
+            insertStmtDirectives(OMPAD, "atomic write", snippet, fields, clauses);
+	  else if (isa<OMPReadClause>(OMPED->getClause(0)))
+            insertStmtDirectives(OMPAD, "atomic read", snippet, fields, clauses);
+	  else if (isa<OMPUpdateClause>(OMPED->getClause(0)))
+            insertStmtDirectives(OMPAD, "atomic update", snippet, fields, clauses);
+	}
+	else
+	  insertStmtDirectives(OMPAD, "atomic", snippet, fields, clauses);
+      }
+
+      clauses["pragma type"] = classifyPragma(OMPED, (clauses.count("parallel") > 0) == true);
+
+      if (isa<OMPTargetDataDirective>(OMPED) ||
+           isa<OMPTargetEnterDataDirective>(OMPED) ||
+           isa<OMPTargetExitDataDirective>(OMPED))
+	 clauses["offload"] = "false";
+
+      for (int i = 0, ie = OMPED->getNumClauses(); i != ie; i++)
+        ClassifyClause(OMPED->getClause(i), clauses);
+    
+      for (int i = 0, ie = nodes_list.size(); i != ie; i++) {
+        if (OMPOrderedDirective *OMPOD = dyn_cast<OMPOrderedDirective>(nodes_list[i]))
+	  associateEachLoopInside(OMPOD, clauses);
+	if (OMPAtomicDirective *OMPAD = dyn_cast<OMPAtomicDirective>(nodes_list[i]))
+	  associateEachLoopInside(OMPAD, clauses);
+	if (OMPCriticalDirective *OMPCD = dyn_cast<OMPCriticalDirective>(nodes_list[i]))
+	  associateEachLoopInside(OMPCD, clauses);
+	if (CallExpr *CE = dyn_cast<CallExpr>(nodes_list[i]))
+	  insertLockNode(CE, clauses);
+      }
+
+      /*we need do associate clauses for:
+       * - collapsed loops
+       * - target directives
+       * - parallel */
+      if ((clauses.count("collapse") != 0) ||
+          (clauses.count("offload") != 0) ||
+	  (clauses.count("parallel") != 0) ||
+	  (isa<OMPTargetDataDirective>(OMPED) ||
+           isa<OMPTargetEnterDataDirective>(OMPED) ||
+           isa<OMPTargetExitDataDirective>(OMPED))) {
+
+	/*the collapsed loops are the perfectly nested ones below the directive*/
+	if (clauses.count("collapse") != 0) {
+          CreateLoopDirectiveNode(OMPED, clauses);
+	  long long int collapse = getCollapseDepth(OMPED);
+	  vector<Stmt*> nest;
+	  getPerfectNest(OMPED->getInnermostCapturedStmt()->getCapturedStmt(), nest);
+	  for (int i = 1, ie = nest.size(); i != ie && i < collapse; i++) {
+	    clauses["collapse"] = to_string(collapse - i);
+	    CreateLoopDirectiveNode(nest[i], clauses);
+	  }
+	}
+
+        for (int i = 0, ie = nodes_list.size(); i != ie; i++) {
+	  if (currFile.visited.count(nodes_list[i]) != 0) 
+	    continue;
+
+	  if (OMPExecutableDirective *OMPEN = dyn_cast<OMPExecutableDirective>(nodes_list[i])) {
+            if (OMPLoopDirective *OMPLD = dyn_cast<OMPLoopDirective>(OMPEN)) {
+              associateEachLoopInside(OMPLD, clauses);
+            }
+	    else if (OMPTargetDataDirective *OMPTD = dyn_cast<OMPTargetDataDirective>(OMPEN)) {
+              associateEachLoopInside(OMPED, clauses); 
+	    }
+	    else if (OMPParallelDirective *OMPPD = dyn_cast<OMPParallelDirective>(OMPEN)) {
+              associateEachLoopInside(OMPPD, clauses);
+            }
+	    else if (OMPTargetDirective *OMPTD = dyn_cast<OMPTargetDirective>(OMPEN)) {
+      	      associateEachLoopInside(OMPTD, clauses);
+	    }
+	  }
+        }
+      }
+
+      if (OMPLoopDirective *OMPLD = dyn_cast<OMPLoopDirective>(OMPED)) {
+        CreateLoopDirectiveNode(OMPED, clauses);
+      }
+    }
+
+    /*Populate a map with the defined lines, to do that, we consider everything inside a statment as
+     * a vector of characters, then we define new ids whenever we find the token ";".
+     * The goal is be able to recover relative positions to statments when necessary, for example,
+     * instructions inside a loop */
+    void recoverCodeSnippetsID(Stmt *st, map<Stmt*, long long int> & mapped_statments, long long int loopID) {
+      string snippet = getSourceSnippet(st->getSourceRange(), true, false);
+/*
+      string snippet;
+      llvm::raw_string_ostream outstream(snippet);
+      //body->printPretty(outstream, NULL, PrintingPolicy(lo));
+      st->dump(outstream, *astContext);
+*/
+      // The separator ref vector have the following format:
+      // <line, column>, where that is the position of the character ';' in the source code
+      // and the position of the vector is the relative id;
+      vector<pair<int, int> > separator_ref;
+      int line = 0;
+      int column = 0;
+      for (int i = 0, ie = snippet.size(); i < ie; i++) {
+	// Store the positions with the character ';'
+        if (snippet[i] == ';')
+	  separator_ref.push_back(make_pair(line, column));
+	column++;
+	if (snippet[i] == '\n') {
+	  line++;
+	  column = 0;
+	}
+      }
+
+      if (snippet[(snippet.size() - 1)] != ';')
+        separator_ref.push_back(make_pair(line, column));
+
+      vector<Stmt*> nodes_list;
+      visitNodes(st, nodes_list);
+      for (int i = 0, ie = nodes_list.size(); i != ie; i++) {
+        FullSourceLoc StartLocation = astContext->getFullLoc(nodes_list[i]->getBeginLoc());
+        FullSourceLoc EndLocation = astContext->getFullLoc(nodes_list[i]->getEndLoc());
+	if (!StartLocation.isValid() || !EndLocation.isValid()) 
+	  continue;
+
+	int line  = EndLocation.getSpellingLineNumber();
+        int column = EndLocation.getSpellingColumnNumber();
+
+	mapped_statments[nodes_list[i]] = -1;
+	for (int j = 0, je = separator_ref.size(); j != je; j++) {
+          if (separator_ref[i].first == line) {
+            if (separator_ref[i].second >= column) {
+              mapped_statments[nodes_list[i]] = j + 1;
+	      break;
+	    }
+	  }
+	  else if (separator_ref[i].first > line) {
+            mapped_statments[nodes_list[i]] = j + 1;
+	    break;
+	  }
+	}
+	if (mapped_statments[nodes_list[i]] == -1)
+	  mapped_statments[nodes_list[i]] = separator_ref.size();
+
+	// Associate the statment with a relative position. Provides facilities to recover the relative position
+	// after this process
+	struct InputFile& currFile = FileStack.top();
+	currFile.loopInstID[nodes_list[i]].filename = currFile.filename;
+	string functionName = currFile.mapFunctionName[nodes_list[i]];
+	currFile.loopInstID[nodes_list[i]].functionName = functionName;
+	currFile.loopInstID[nodes_list[i]].functionLoopID = loopID;
+        currFile.loopInstID[nodes_list[i]].loopInstructionID = mapped_statments[nodes_list[i]];
+      }
+    }
+
+    /*visits all nodes of type decl*/
+    virtual bool VisitDecl(Decl *D) {
+	struct InputFile& currFile = FileStack.top();
+	if (FunctionDecl *FD = dyn_cast<FunctionDecl>(D)) {
+      	  if (FD->doesThisDeclarationHaveABody()) {
+	    const SourceManager& mng = astContext->getSourceManager();
+            if (astContext->getSourceManager().isInSystemHeader(D->getLocation())) {
+              return true;
+            }
+
+            string filename = mng.getFilename(D->getBeginLoc()).str();
 
             if (FileStack.empty() || FileStack.top().filename != filename) {
       	       NewInputFile(filename);
@@ -973,6 +5408,9 @@ public:
 		
 	      recoverCodeSnippetsID(st, currFile.loopInstructionID[st], currFile.functionLoopID[funcName][I->second]);
 	    }
+	    insertFirstTouchNodes(FD);
+	    insertTransferNodes(FD);
+	    insertDataLifetimeNodes(FD);
 	  }
 	}
       return true;
@@ -999,12 +5437,11 @@ public:
           errs() << "OMPExec StmtClass: " << cls << ":" << st->getStmtClassName() << "\n";
 	  associateEachLoopInside(OMPED, clauses);
 	}
-/*
+	/*loops outside OpenMP regions are checked for missed parallelism*/
 	if (isa<DoStmt>(st) || isa<ForStmt>(st) || isa<WhileStmt>(st)) {
-          CreateLoopNode(st);
-          errs() << "Do StmtClass: " << cls << ":" << st->getStmtClassName() << "\n";
+	  if (!isInsideDirective(st))
+            CreateLoopNode(st);
 	}
-*/
         return true;
     }
 };
@@ -1015,8 +5452,8 @@ private:
 
 public:
     /*override the constructor in order to pass CI*/
-    explicit PragmaASTConsumer(CompilerInstance *CI, bool ClDCSnippet)
-        : visitor(new PragmaVisitor(CI, ClDCSnippet)) // initialize the visitor
+    explicit PragmaASTConsumer(CompilerInstance *CI, bool ClDCSnippet, MachineDesc machine)
+        : visitor(new PragmaVisitor(CI, ClDCSnippet, machine)) // initialize the visitor
     { }
 
     /*empties node stack (in between different translation units)*/
@@ -1080,12 +5517,62 @@ public:
 class PragmaPluginAction : public PluginASTAction {
 protected:
     bool ClDCSnippet = true;
+    MachineDesc machine;
 
     /*This gets called by Clang when it invokes our Plugin.
     Has to be unique pointer (this bit was a bitch to figure out*/
     unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &CI, 
                                               StringRef file) {
-        return make_unique<PragmaASTConsumer>(&CI, this->ClDCSnippet);
+        return make_unique<PragmaASTConsumer>(&CI, this->ClDCSnippet, this->machine);
+    }
+
+    /*read the "key value" pairs of a machine description file*/
+    bool readMachineDesc(std::string filename) {
+      ifstream infile(filename);
+      if (!infile.is_open())
+        return false;
+
+      std::string line;
+      while (getline(infile, line)) {
+        StringRef entry = StringRef(line).trim();
+        if (entry.empty() || entry[0] == '#')
+          continue;
+
+        size_t separator = entry.find_first_of(" \t");
+        StringRef key = entry.substr(0, separator);
+        StringRef valueStr = entry.substr(separator).trim();
+        double value = 0.0;
+        if (valueStr.getAsDouble(value) || value <= 0.0) {
+          errs() << "Invalid value in machine description: " << line << "\n";
+          return false;
+        }
+        /*counts and sizes must be whole numbers that fit their fields*/
+        bool integral = (key == "threads" || key == "cache_line" || key == "l1_cache" || key == "l2_cache");
+        if (integral && (value > 4294967295.0 || value != (double) (unsigned int) value)) {
+          errs() << "Invalid value in machine description: " << line << "\n";
+          return false;
+        }
+
+        if (key == "peak_gflops")
+          machine.peakGflops = value;
+        else if (key == "bandwidth_gbs")
+          machine.bandwidthGBs = value;
+        else if (key == "threads")
+          machine.threads = (unsigned int) value;
+        else if (key == "cache_line")
+          machine.cacheLine = (unsigned int) value;
+        else if (key == "min_parallel_work")
+          machine.minParallelWork = value;
+        else if (key == "min_offload_work")
+          machine.minOffloadWork = value;
+        else if (key == "l1_cache")
+          machine.l1Cache = (unsigned int) value;
+        else if (key == "l2_cache")
+          machine.l2Cache = (unsigned int) value;
+        else
+          errs() << "Unknown key in machine description: " << key << "\n";
+      }
+      return true;
     }
 
     /*leaving this here as a placeholder for now, we can implement a function
@@ -1095,6 +5582,13 @@ protected:
         if (args[i] == "-code-snippet-gen") {
            ClDCSnippet = true;
         }
+        if (args[i].find("-machine-desc=") == 0) {
+          std::string filename = args[i].substr(std::string("-machine-desc=").size());
+          if (!readMachineDesc(filename)) {
+            errs() << "Failed to read machine description file: " << filename << "\n";
+            return false;
+          }
+        }
       }
       return true;
     }